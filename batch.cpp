@@ -0,0 +1,265 @@
+/**
+ * @file batch.cpp
+ *
+ * This file implements the batch runner on top of the work-stealing scheduler. Every entry
+ * of the batch is one task, dealt to the workers in turn. An entry with memory images is
+ * decoded once and then spawns one task per chunk of images, which other workers steal when
+ * they run out of work. The calling thread writes results strictly in batch order, each as
+ * soon as it and all the results before it are ready, so output streams while later
+ * programs still run.
+ *
+ * @date May 4, 2025
+ */
+
+#include "batch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <string_view>
+#include <thread>
+
+#include "machine.hpp"
+#include "multi_instance.hpp"
+#include "scheduler.hpp"
+#include "software.hpp"
+#include "values.hpp"
+
+using namespace std;
+
+/**
+ * @struct BatchJob
+ *
+ * The state of one entry of the batch. The decoded program, the images, the instance
+ * results and the errors of the chunks that failed are only used by entries with memory
+ * images. The chunk errors and the written result are guarded by the runner's mutex.
+ */
+struct BatchJob {
+    Program program;
+    vector<vector<uint8_t>> images;
+    vector<InstanceResult> instance_results;
+    atomic<size_t> remaining_chunks = 0;
+    string chunk_errors;
+
+    string output;
+    string errors;
+    bool is_succeeded = false;
+    bool is_done = false;
+};
+
+/**
+ * A scheduler task names an entry of the batch and a part of it: chunk 0 is the whole
+ * entry, chunk n > 0 the n-th chunk of its memory images.
+ */
+constexpr unsigned TASK_ENTRY_SHIFT = 32;
+
+constexpr WorkStealingScheduler::Task make_task(const size_t entry, const size_t chunk) {
+    return static_cast<WorkStealingScheduler::Task>(entry) << TASK_ENTRY_SHIFT | chunk;
+}
+
+/**
+ * Computes how many worker threads to run a batch on: one per core, but no more than there
+ * are entries
+ *
+ * @param entries_number The number of entries in the batch
+ * @return size_t The number of workers, at least 1
+ */
+size_t BatchRunner::get_workers_number(const size_t entries_number) {
+    const size_t cores_number = max<size_t>(thread::hardware_concurrency(), 1);
+
+    return max<size_t>(min(cores_number, entries_number), 1);
+}
+
+/**
+ * Runs every entry of the batch and writes what each of them printed to output, in batch
+ * order. Errors are written to errors, every line prefixed with the path of its program.
+ *
+ * @param entries The programs to run, with their memory images files
+ * @param output The stream program output is written to
+ * @param errors The stream program errors are written to
+ * @param format How the programs write printed values; entries with memory images always
+ * write text
+ * @param is_workers_report Whether to write how busy every worker was to errors at the end
+ * @param load_options How to load the program files
+ * @return bool true if every program was loaded and ran to its end
+ */
+bool BatchRunner::run(const vector<BatchEntry>& entries, ostream& output, ostream& errors,
+                      const OutputFormat format, const bool is_workers_report,
+                      const LoadOptions& load_options) {
+    vector<BatchJob> jobs(entries.size());
+    mutex jobs_mutex;
+    condition_variable job_done;
+    WorkStealingScheduler scheduler(get_workers_number(entries.size()));
+    const size_t chunk_size = HardcodedValues::get_instances_chunk_size();
+    LoadOptions entry_load_options = load_options;
+
+    // The workers already keep every core busy
+    if (entry_load_options.loader == LOADER_PARALLEL) entry_load_options.loader = LOADER_MMAP;
+
+    const auto finish = [&](BatchJob& job, const ostringstream& job_output,
+                            const ostringstream& job_errors, const bool is_succeeded) {
+        {
+            const lock_guard<mutex> lock(jobs_mutex);
+            job.output = job_output.str();
+            job.errors = job_errors.str();
+            job.is_succeeded = is_succeeded;
+            job.is_done = true;
+        }
+
+        job_done.notify_all();
+    };
+
+    // Decodes an entry and runs it, or spawns the chunks of its instances
+    const auto run_entry = [&](const size_t index, const size_t worker) {
+        const BatchEntry& entry = entries[index];
+        BatchJob& job = jobs[index];
+        ostringstream job_output;
+        ostringstream job_errors;
+
+        try {
+            if (entry.images_path.empty()) {
+                Machine machine(job_output, FLUSH_ON_EXIT, format,
+                                entry_load_options.memory_size, entry_load_options.stack_size);
+                const bool is_succeeded =
+                    functools::run_file(machine, entry.program_path, false, job_errors,
+                                        entry_load_options);
+                finish(job, job_output, job_errors, is_succeeded);
+                return;
+            }
+
+            optional<Program> program =
+                functools::decode(entry.program_path, job_errors, entry_load_options);
+            optional<vector<vector<uint8_t>>> images =
+                program ? functools::read_images(entry.images_path, entry_load_options.memory_size,
+                                                 job_errors)
+                        : nullopt;
+
+            if (!program || !images) {
+                finish(job, job_output, job_errors, false);
+                return;
+            }
+
+            const size_t chunks_number = (images -> size() + chunk_size - 1) / chunk_size;
+
+            if (chunks_number == 0) {
+                finish(job, job_output, job_errors, true);
+                return;
+            }
+
+            job.program = move(*program);
+            job.images = move(*images);
+            job.instance_results.resize(job.images.size());
+            job.remaining_chunks.store(chunks_number, memory_order_relaxed);
+
+            for (size_t chunk = 1; chunk <= chunks_number; ++chunk) {
+                scheduler.spawn(make_task(index, chunk), worker);
+            }
+        } catch (const exception& error) {
+            job_errors << error.what() << endl;
+            finish(job, job_output, job_errors, false);
+        }
+    };
+
+    // Runs one chunk of instances; the last chunk to finish writes the results of the entry,
+    // or the errors of the chunks that failed to run, if any did
+    const auto run_chunk = [&](const size_t index, const size_t chunk) {
+        BatchJob& job = jobs[index];
+        const size_t begin = (chunk - 1) * chunk_size;
+        const size_t count = min(chunk_size, job.images.size() - begin);
+
+        try {
+            vector<InstanceResult> results =
+                MultiInstanceEngine::run(job.program, span(job.images).subspan(begin, count),
+                                         entry_load_options.memory_size,
+                                         entry_load_options.stack_size);
+            move(results.begin(), results.end(),
+                 job.instance_results.begin() + static_cast<ptrdiff_t>(begin));
+        } catch (const exception& error) {
+            const lock_guard<mutex> lock(jobs_mutex);
+            job.chunk_errors += error.what();
+            job.chunk_errors += '\n';
+        }
+
+        if (job.remaining_chunks.fetch_sub(1, memory_order_acq_rel) != 1) return;
+
+        ostringstream job_output;
+        ostringstream job_errors;
+        bool is_succeeded = false;
+
+        {
+            const lock_guard<mutex> lock(jobs_mutex);
+            job_errors << job.chunk_errors;
+        }
+
+        if (job_errors.view().empty()) {
+            try {
+                is_succeeded = functools::write_instance_results(job.instance_results,
+                                                                 job_output, job_errors);
+            } catch (const exception& error) {
+                job_errors << error.what() << endl;
+            }
+        }
+
+        job.images = {};
+        job.instance_results = {};
+        finish(job, job_output, job_errors, is_succeeded);
+    };
+
+    for (size_t index = 0; index < entries.size(); ++index) scheduler.submit(make_task(index, 0));
+
+    scheduler.start([&](const WorkStealingScheduler::Task task, const size_t worker) {
+        const auto index = static_cast<size_t>(task >> TASK_ENTRY_SHIFT);
+        const auto chunk = static_cast<size_t>(task & ((1ULL << TASK_ENTRY_SHIFT) - 1));
+
+        if (chunk == 0)
+            run_entry(index, worker);
+        else
+            run_chunk(index, chunk);
+    });
+
+    bool is_succeeded = true;
+
+    for (size_t index = 0; index < entries.size(); ++index) {
+        BatchJob& job = jobs[index];
+        string job_output;
+        string job_errors;
+        bool is_job_succeeded = false;
+
+        {
+            unique_lock<mutex> lock(jobs_mutex);
+            job_done.wait(lock, [&]() { return job.is_done; });
+            job_output = move(job.output);
+            job_errors = move(job.errors);
+            is_job_succeeded = job.is_succeeded;
+        }
+
+        output << job_output;
+
+        if (!is_job_succeeded) {
+            output.flush();
+
+            string_view lines = job_errors;
+
+            while (!lines.empty()) {
+                const size_t end = lines.find('\n');
+                errors << entries[index].program_path << ": " << lines.substr(0, end) << '\n';
+                lines = end == string_view::npos ? string_view() : lines.substr(end + 1);
+            }
+
+            errors.flush();
+            is_succeeded = false;
+        }
+    }
+
+    output.flush();
+    scheduler.join();
+
+    if (is_workers_report) scheduler.print_report(errors);
+
+    return is_succeeded;
+}
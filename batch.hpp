@@ -0,0 +1,47 @@
+/**
+ * @file batch.hpp
+ *
+ * This file declares the batch runner, which executes many program files in one process on
+ * a work-stealing scheduler with one worker per core. Every program runs on its own Machine
+ * with its output captured, and the captured output is written in batch order. A program
+ * run over memory images is split into chunks of instances that idle workers can steal.
+ *
+ * @date May 4, 2025
+ */
+
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "loader.hpp"
+#include "output.hpp"
+
+using namespace std;
+
+/**
+ * @struct BatchEntry
+ *
+ * One program of a batch, and the memory images file to run it over, if any.
+ */
+struct BatchEntry {
+    string program_path;
+    string images_path;
+};
+
+/**
+ * @class BatchRunner
+ *
+ * Runs a list of program files concurrently and writes their results in list order.
+ */
+class BatchRunner {
+   public:
+    static size_t get_workers_number(size_t entries_number);
+    static bool run(const vector<BatchEntry>& entries, ostream& output, ostream& errors,
+                    OutputFormat format = OUTPUT_TEXT, bool is_workers_report = false,
+                    const LoadOptions& load_options = {});
+};
+
+#endif
@@ -0,0 +1,413 @@
+/**
+ * @file bytecode.cpp
+ *
+ * This file implements reading, writing and disassembling .up3k bytecode files, and the
+ * XXH64 checksum they are protected with.
+ *
+ * @date May 4, 2025
+ */
+
+#include "bytecode.hpp"
+
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstring>
+
+#include "hardware.hpp"
+#include "values.hpp"
+
+using namespace std;
+
+constexpr size_t INSTRUCTION_SIZE = sizeof(Instruction);
+constexpr size_t LINE_SIZE = sizeof(uint64_t);
+constexpr size_t SERIALIZATION_CHUNK_SIZE = 1 << 16;
+static_assert(Bytecode::MAGIC.size() == 4, "the magic fills the first 4 bytes of the header");
+
+/**
+ * Reads a little-endian integer from unaligned bytes.
+ *
+ * @param bytes The bytes to read from.
+ * @return T The integer.
+ */
+template <typename T>
+T read_little_endian(const char* const bytes) {
+    T value;
+    memcpy(&value, bytes, sizeof(T));
+
+    if constexpr (endian::native == endian::big) value = byteswap(value);
+
+    return value;
+}
+
+/**
+ * Appends an integer to a buffer in little-endian order.
+ *
+ * @param buffer The buffer to append to.
+ * @param value The integer.
+ */
+template <typename T>
+void append_little_endian(string& buffer, const T value) {
+    for (size_t byte = 0; byte < sizeof(T); ++byte) {
+        buffer.push_back(static_cast<char>(static_cast<uint64_t>(value) >> (8 * byte)));
+    }
+}
+
+/**
+ * @class Xxh64
+ *
+ * Computes the XXH64 hash of a byte stream fed in pieces of any size.
+ */
+class Xxh64 {
+    static constexpr uint64_t PRIME_1 = 0x9E3779B185EBCA87;
+    static constexpr uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4F;
+    static constexpr uint64_t PRIME_3 = 0x165667B19E3779F9;
+    static constexpr uint64_t PRIME_4 = 0x85EBCA77C2B2AE63;
+    static constexpr uint64_t PRIME_5 = 0x27D4EB2F165667C5;
+    static constexpr size_t STRIPE_SIZE = 32;
+
+    array<uint64_t, 4> accumulators = {PRIME_1 + PRIME_2, PRIME_2, 0, 0 - PRIME_1};
+    array<char, STRIPE_SIZE> pending = {};
+    size_t pending_size = 0;
+    uint64_t total_size = 0;
+
+    static uint64_t round(const uint64_t accumulator, const uint64_t input) {
+        return rotl(accumulator + input * PRIME_2, 31) * PRIME_1;
+    }
+
+    static uint64_t merge_round(const uint64_t hash, const uint64_t accumulator) {
+        return (hash ^ round(0, accumulator)) * PRIME_1 + PRIME_4;
+    }
+
+    void consume_stripe(const char* const stripe) {
+        for (size_t lane = 0; lane < accumulators.size(); ++lane) {
+            accumulators[lane] = round(accumulators[lane],
+                                       read_little_endian<uint64_t>(stripe + lane * LINE_SIZE));
+        }
+    }
+
+   public:
+    void update(const char* bytes, size_t size) {
+        total_size += size;
+
+        if (pending_size > 0) {
+            const size_t taken = min(size, STRIPE_SIZE - pending_size);
+            memcpy(pending.data() + pending_size, bytes, taken);
+            pending_size += taken;
+            bytes += taken;
+            size -= taken;
+
+            if (pending_size < STRIPE_SIZE) return;
+
+            consume_stripe(pending.data());
+            pending_size = 0;
+        }
+
+        for (; size >= STRIPE_SIZE; bytes += STRIPE_SIZE, size -= STRIPE_SIZE) {
+            consume_stripe(bytes);
+        }
+
+        memcpy(pending.data(), bytes, size);
+        pending_size = size;
+    }
+
+    uint64_t digest() const {
+        uint64_t hash = PRIME_5;
+
+        if (total_size >= STRIPE_SIZE) {
+            hash = rotl(accumulators[0], 1) + rotl(accumulators[1], 7) +
+                   rotl(accumulators[2], 12) + rotl(accumulators[3], 18);
+
+            for (const uint64_t accumulator : accumulators) hash = merge_round(hash, accumulator);
+        }
+
+        hash += total_size;
+
+        const char* tail = pending.data();
+        size_t size = pending_size;
+
+        for (; size >= 8; tail += 8, size -= 8) {
+            hash ^= round(0, read_little_endian<uint64_t>(tail));
+            hash = rotl(hash, 27) * PRIME_1 + PRIME_4;
+        }
+
+        if (size >= 4) {
+            hash ^= read_little_endian<uint32_t>(tail) * PRIME_1;
+            hash = rotl(hash, 23) * PRIME_2 + PRIME_3;
+            tail += 4;
+            size -= 4;
+        }
+
+        for (; size > 0; ++tail, --size) {
+            hash = rotl(hash ^ static_cast<uint8_t>(*tail) * PRIME_5, 11) * PRIME_1;
+        }
+
+        hash ^= hash >> 33;
+        hash *= PRIME_2;
+        hash ^= hash >> 29;
+        hash *= PRIME_3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+};
+
+/**
+ * Serializes everything after the header, handing it to a sink one chunk at a time.
+ *
+ * @param program The program to serialize.
+ * @param is_lines Whether to serialize the line table.
+ * @param sink Called with every chunk.
+ */
+template <typename Sink>
+void serialize_payload(const Program& program, const bool is_lines, Sink&& sink) {
+    string chunk;
+    chunk.reserve(SERIALIZATION_CHUNK_SIZE);
+
+    const auto flush_if_full = [&] {
+        if (chunk.size() < SERIALIZATION_CHUNK_SIZE) return;
+
+        sink(chunk);
+        chunk.clear();
+    };
+
+    for (const Instruction& instruction : program.instructions) {
+        chunk.push_back(static_cast<char>(instruction.opcode));
+        chunk.push_back(static_cast<char>(instruction.operands_number));
+
+        for (const OperandType type : instruction.types) chunk.push_back(static_cast<char>(type));
+        for (const uint16_t value : instruction.values) append_little_endian(chunk, value);
+
+        flush_if_full();
+    }
+
+    for (size_t index = 0; is_lines && index < program.instructions.size(); ++index) {
+        append_little_endian(chunk, static_cast<uint64_t>(program.get_line(index)));
+        flush_if_full();
+    }
+
+    if (!chunk.empty()) sink(chunk);
+}
+
+/**
+ * Tells whether a file starts like a bytecode file
+ *
+ * @param bytes The contents of the file, or at least its beginning
+ * @return bool: true if the bytes start with the bytecode magic
+ */
+bool Bytecode::is_bytecode(const string_view bytes) {
+    return bytes.starts_with(MAGIC);
+}
+
+/**
+ * Reads a bytecode file into a program. With a mapping on a little-endian host, the program
+ * views its instructions and lines straight in the mapped bytes and keeps the mapping alive;
+ * otherwise they are copied out. Every field is checked, so that a damaged file is rejected
+ * here rather than executed.
+ *
+ * @param path The path to the file, for error messages
+ * @param bytes The contents of the file
+ * @param mapping The mapping the bytes are in, or nullptr if they must be copied
+ * @param program The program to read into
+ * @param errors The stream errors are reported to
+ * @return bool: true if the file is a well-formed bytecode file
+ */
+bool Bytecode::read(const string& path, const string_view bytes,
+                    shared_ptr<const MappedFile> mapping, Program& program, ostream& errors) {
+    if (bytes.size() < HEADER_SIZE || !is_bytecode(bytes)) {
+        errors << ErrorMessages::get_malformed_bytecode_error() << path << endl;
+        return false;
+    }
+
+    const auto version = read_little_endian<uint16_t>(bytes.data() + 4);
+    const auto flags = read_little_endian<uint16_t>(bytes.data() + 6);
+    const auto instructions_number = read_little_endian<uint64_t>(bytes.data() + 8);
+    const auto checksum = read_little_endian<uint64_t>(bytes.data() + 16);
+
+    if (version != VERSION) {
+        errors << ErrorMessages::get_bytecode_version_error() << path << endl;
+        return false;
+    }
+
+    const bool is_lines = (flags & LINES_FLAG) != 0;
+    const size_t record_size = INSTRUCTION_SIZE + (is_lines ? LINE_SIZE : 0);
+    const string_view payload = bytes.substr(HEADER_SIZE);
+
+    if ((flags & ~LINES_FLAG) != 0 || instructions_number > payload.size() / record_size ||
+        instructions_number * record_size != payload.size()) {
+        errors << ErrorMessages::get_malformed_bytecode_error() << path << endl;
+        return false;
+    }
+
+    if (hash(payload) != checksum) {
+        errors << ErrorMessages::get_bytecode_checksum_error() << path << endl;
+        return false;
+    }
+
+    const size_t count = instructions_number;
+    const char* const lines = payload.data() + count * INSTRUCTION_SIZE;
+
+    if (mapping && endian::native == endian::little && sizeof(size_t) == LINE_SIZE) {
+        program.instructions = {reinterpret_cast<const Instruction*>(payload.data()), count};
+        program.lines = {reinterpret_cast<const size_t*>(lines), is_lines ? count : 0};
+        program.mapping = move(mapping);
+    } else {
+        program.decoded_instructions.resize(count);
+
+        for (size_t index = 0; index < count; ++index) {
+            const char* const record = payload.data() + index * INSTRUCTION_SIZE;
+            Instruction& instruction = program.decoded_instructions[index];
+
+            instruction.opcode = static_cast<Opcode>(record[0]);
+            instruction.operands_number = static_cast<uint8_t>(record[1]);
+            instruction.types[0] = static_cast<OperandType>(record[2]);
+            instruction.types[1] = static_cast<OperandType>(record[3]);
+            instruction.values[0] = read_little_endian<uint16_t>(record + 4);
+            instruction.values[1] = read_little_endian<uint16_t>(record + 6);
+        }
+
+        for (size_t index = 0; is_lines && index < count; ++index) {
+            program.decoded_lines.push_back(
+                read_little_endian<uint64_t>(lines + index * LINE_SIZE));
+        }
+
+        program.instructions = program.decoded_instructions;
+        program.lines = program.decoded_lines;
+    }
+
+    for (size_t index = 0; index < count; ++index) {
+        const size_t previous_line = index > 0 ? program.get_line(index - 1) : 0;
+        const bool is_line_valid = program.get_line(index) > previous_line;
+
+        if (!is_valid_instruction(program.instructions[index]) || !is_line_valid) {
+            errors << ErrorMessages::get_malformed_bytecode_error() << path << endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Writes a program in the bytecode format. The payload is serialized twice, once to
+ * checksum it and once to write it, so that the stream need not be seekable.
+ *
+ * @param program The program to write
+ * @param output The stream to write to
+ * @return void: Nothing
+ */
+void Bytecode::write(const Program& program, ostream& output) {
+    const bool is_lines = has_line_table(program);
+    Xxh64 hash;
+
+    serialize_payload(program, is_lines, [&](const string& chunk) {
+        hash.update(chunk.data(), chunk.size());
+    });
+
+    string header(MAGIC);
+    append_little_endian(header, VERSION);
+    append_little_endian(header, static_cast<uint16_t>(is_lines ? LINES_FLAG : 0));
+    append_little_endian(header, static_cast<uint64_t>(program.instructions.size()));
+    append_little_endian(header, hash.digest());
+    output.write(header.data(), static_cast<streamsize>(header.size()));
+
+    serialize_payload(program, is_lines, [&](const string& chunk) {
+        output.write(chunk.data(), static_cast<streamsize>(chunk.size()));
+    });
+}
+
+/**
+ * Writes a program back as text, one instruction per line. Empty lines are inserted so that
+ * every instruction lands on its source line.
+ *
+ * @param program The program to write
+ * @param output The stream to write to
+ * @return void: Nothing
+ */
+void Bytecode::write_text(const Program& program, ostream& output) {
+    const auto& symbols = RegistersManager::get_registers_symbols();
+    string text;
+    size_t line = 0;
+
+    text.reserve(SERIALIZATION_CHUNK_SIZE);
+
+    for (size_t index = 0; index < program.instructions.size(); ++index) {
+        const Instruction& instruction = program.instructions[index];
+
+        for (++line; line < program.get_line(index); ++line) text.push_back('\n');
+
+        text += OPCODES_NAMES[instruction.opcode];
+
+        for (size_t operand = 0; operand < instruction.operands_number; ++operand) {
+            text.push_back(HardcodedValues::get_delimiter_symbol());
+
+            if (instruction.types[operand] == REGISTER) {
+                text += symbols[instruction.values[operand]];
+            } else {
+                char digits[5];  // "65535"
+                text.append(digits, to_chars(digits, end(digits), instruction.values[operand]).ptr);
+            }
+        }
+
+        text.push_back('\n');
+
+        if (text.size() >= SERIALIZATION_CHUNK_SIZE) {
+            output.write(text.data(), static_cast<streamsize>(text.size()));
+            text.clear();
+        }
+    }
+
+    output.write(text.data(), static_cast<streamsize>(text.size()));
+}
+
+/**
+ * Hashes bytes with XXH64, the hash bytecode files are checksummed with
+ *
+ * @param bytes The bytes to hash
+ * @return uint64_t: The hash
+ */
+uint64_t Bytecode::hash(const string_view bytes) {
+    Xxh64 hash;
+    hash.update(bytes.data(), bytes.size());
+    return hash.digest();
+}
+
+/**
+ * Checks that every field of an instruction holds something the decoder could have produced
+ *
+ * @param instruction The instruction to check
+ * @return bool: true if the instruction is well-formed
+ */
+bool Bytecode::is_valid_instruction(const Instruction& instruction) {
+    if (instruction.opcode >= OPCODES_NUMBER ||
+        instruction.operands_number > Instruction::MAX_OPERANDS_NUMBER)
+        return false;
+
+    for (size_t operand = 0; operand < Instruction::MAX_OPERANDS_NUMBER; ++operand) {
+        const OperandType type = instruction.types[operand];
+        const uint16_t value = instruction.values[operand];
+
+        if (operand >= instruction.operands_number) {
+            if (type != NONE || value != 0) return false;
+        } else if (type == NONE || type >= OPERAND_TYPES_NUMBER ||
+                   (type == REGISTER && value >= RegistersManager::REGISTERS_NUMBER)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Tells whether a program needs a line table, that is whether some instruction is not on
+ * the line after the previous one
+ *
+ * @param program The program
+ * @return bool: true if the line table must be written
+ */
+bool Bytecode::has_line_table(const Program& program) {
+    for (size_t index = 0; index < program.instructions.size(); ++index) {
+        if (program.get_line(index) != index + 1) return true;
+    }
+
+    return false;
+}
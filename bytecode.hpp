@@ -0,0 +1,60 @@
+/**
+ * @file bytecode.hpp
+ *
+ * This file declares the .up3k bytecode format: a decoded program stored as packed
+ * instructions, which can be executed without parsing any text. All fields are little-endian:
+ *
+ *   offset 0   magic "UP3K"
+ *   offset 4   uint16 format version
+ *   offset 6   uint16 flags; bit 0 is set when a line table follows the instructions
+ *   offset 8   uint64 number of instructions
+ *   offset 16  uint64 XXH64 checksum of everything after the header
+ *   offset 24  the instructions, 8 bytes each: opcode, operands number, the two operand types
+ *              and the two uint16 operand values, exactly as Instruction is laid out
+ *   then       if flagged, the uint64 source line of every instruction
+ *
+ * The line table is left out when every instruction is on the line after the previous one.
+ * On little-endian hosts a mapped bytecode file is executed in place.
+ *
+ * @date May 4, 2025
+ */
+
+#ifndef BYTECODE_HPP
+#define BYTECODE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "instructions.hpp"
+#include "loader.hpp"
+
+using namespace std;
+
+/**
+ * @class Bytecode
+ *
+ * Reads and writes programs in the .up3k bytecode format, and writes them back as text.
+ */
+class Bytecode {
+   public:
+    static constexpr string_view MAGIC = "UP3K";
+    static constexpr uint16_t VERSION = 1;
+    static constexpr uint16_t LINES_FLAG = 1;
+    static constexpr size_t HEADER_SIZE = 24;
+
+    static bool is_bytecode(string_view bytes);
+    static bool read(const string& path, string_view bytes, shared_ptr<const MappedFile> mapping,
+                     Program& program, ostream& errors);
+    static void write(const Program& program, ostream& output);
+    static void write_text(const Program& program, ostream& output);
+    static uint64_t hash(string_view bytes);
+
+   private:
+    static bool is_valid_instruction(const Instruction& instruction);
+    static bool has_line_table(const Program& program);
+};
+
+#endif
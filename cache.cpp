@@ -0,0 +1,94 @@
+/**
+ * @file cache.cpp
+ *
+ * This file implements the decoded-program cache.
+ *
+ * @date May 4, 2025
+ */
+
+#include "cache.hpp"
+
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+
+#include "bytecode.hpp"
+#include "loader.hpp"
+
+using namespace std;
+
+/**
+ * Names the cache entry of a program text
+ *
+ * @param cache_directory The cache directory
+ * @param text The program text
+ * @return string: The path of the entry, whether it exists or not
+ */
+string ProgramCache::get_entry_path(const string& cache_directory, const string_view text) {
+    const uint64_t hash = Bytecode::hash(text);
+    char digits[16];  // the hash in hexadecimal, zero-padded
+    char* const end = to_chars(digits, digits + sizeof(digits), hash, 16).ptr;
+    string name(static_cast<size_t>(digits + sizeof(digits) - end), '0');
+
+    name.append(digits, end);
+    name += '-' + to_string(text.size()) + ".up3k";
+    return (filesystem::path(cache_directory) / name).string();
+}
+
+/**
+ * Loads a program from its cache entry. The entry is mapped and executed in place, like any
+ * bytecode file.
+ *
+ * @param entry_path The path of the entry
+ * @param program The program to load into; left untouched if the entry cannot be used
+ * @return bool: true if the entry exists and is well-formed
+ */
+bool ProgramCache::read(const string& entry_path, Program& program) {
+    auto mapping = make_shared<const MappedFile>(entry_path);
+
+    if (!mapping->is_mapped()) return false;
+
+    // A stale entry is not an error, it is simply decoded again
+    ostream discarded(nullptr);
+    Program cached;
+
+    if (!Bytecode::read(entry_path, mapping->get_text(), mapping, cached, discarded)) return false;
+
+    program = move(cached);
+    return true;
+}
+
+/**
+ * Stores a decoded program as a cache entry, creating the cache directory if needed. The
+ * entry is written aside and renamed into place, so that concurrent loaders never see it
+ * half written. Failures are ignored: the program is simply decoded again next time.
+ *
+ * @param entry_path The path of the entry
+ * @param program The decoded program
+ * @return void: Nothing
+ */
+void ProgramCache::write(const string& entry_path, const Program& program) {
+    error_code error;
+    filesystem::create_directories(filesystem::path(entry_path).parent_path(), error);
+
+    string temporary_path = entry_path + ".XXXXXX";
+    const int descriptor = mkstemp(temporary_path.data());
+
+    if (descriptor < 0) return;
+
+    // Entries may be shared by other users; mkstemp makes them private
+    fchmod(descriptor, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    close(descriptor);
+
+    ofstream entry(temporary_path, ios::binary | ios::trunc);
+    Bytecode::write(program, entry);
+    entry.close();
+
+    if (!entry || rename(temporary_path.c_str(), entry_path.c_str()) != 0)
+        remove(temporary_path.c_str());
+}
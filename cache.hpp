@@ -0,0 +1,35 @@
+/**
+ * @file cache.hpp
+ *
+ * This file declares the decoded-program cache: a directory of .up3k bytecode files, each
+ * named after the XXH64 hash and the size of the program text it was decoded from. A program
+ * file whose text is already in the cache is loaded from its bytecode instead of being
+ * parsed. The cache is best-effort: an entry that is missing, damaged or of another format
+ * version is decoded from text again and rewritten.
+ *
+ * @date May 4, 2025
+ */
+
+#ifndef CACHE_HPP
+#define CACHE_HPP
+
+#include <string>
+#include <string_view>
+
+#include "instructions.hpp"
+
+using namespace std;
+
+/**
+ * @class ProgramCache
+ *
+ * Looks up, reads and writes the cache entries of program texts.
+ */
+class ProgramCache {
+   public:
+    static string get_entry_path(const string& cache_directory, string_view text);
+    static bool read(const string& entry_path, Program& program);
+    static void write(const string& entry_path, const Program& program);
+};
+
+#endif
@@ -0,0 +1,85 @@
+/**
+ * @file guard.cpp
+ *
+ * This file implements the stack guard and its SIGSEGV handler.
+ *
+ * @date May 4, 2025
+ */
+
+#include "guard.hpp"
+
+#include <mutex>
+#include <ucontext.h>
+
+#include "memory.hpp"
+
+using namespace std;
+
+thread_local StackGuard* StackGuard::active = nullptr;
+struct sigaction StackGuard::previous_action;
+
+/**
+ * Starts watching the stack of a machine on the current thread, installing the SIGSEGV
+ * handler the first time
+ *
+ * @param memory The memory whose stack to watch
+ */
+StackGuard::StackGuard(const Memory& memory) : memory(memory), previous(active) {
+    install();
+    active = this;
+}
+
+/**
+ * Stops watching, handing the thread back to the enclosing guard, if any
+ */
+StackGuard::~StackGuard() {
+    active = previous;
+}
+
+/**
+ * Installs handle_fault for SIGSEGV, once per process
+ *
+ * @return void: Nothing
+ */
+void StackGuard::install() {
+    static once_flag installed;
+
+    call_once(installed, [] {
+        struct sigaction action = {};
+        action.sa_sigaction = handle_fault;
+        action.sa_flags = SA_SIGINFO;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGSEGV, &action, &previous_action);
+    });
+}
+
+/**
+ * Handles SIGSEGV: jumps back to the active guard of the thread if the fault is on a guard
+ * page of the stack it watches. Any other fault is a bug, so the previous handler is put
+ * back and the faulting access, retried on return, reaches it.
+ *
+ * @param signal_number SIGSEGV
+ * @param info Where the fault happened
+ * @param context The interrupted thread state
+ * @return void: Nothing
+ */
+void StackGuard::handle_fault(const int signal_number, siginfo_t* const info, void* const context) {
+    StackGuard* const guard = active;
+    const string_view fault_error =
+        guard != nullptr ? guard->memory.get_stack_fault_error(info->si_addr) : string_view();
+
+    if (fault_error.empty()) {
+        sigaction(signal_number, &previous_action, nullptr);
+        return;
+    }
+
+    guard->error = fault_error;
+#if defined(__x86_64__)
+    guard->instruction_address =
+        static_cast<uintptr_t>(static_cast<ucontext_t*>(context)->uc_mcontext.gregs[REG_RIP]);
+#else
+    (void)context;
+    guard->instruction_address = 0;
+#endif
+    siglongjmp(guard->jump, 1);
+}
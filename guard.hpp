@@ -0,0 +1,54 @@
+/**
+ * @file guard.hpp
+ *
+ * This file declares the stack guard, which turns a fault on a guard page of a machine stack
+ * into a stack overflow or underflow error instead of a crash. Code that pushes and pops a
+ * guarded stack without any bounds check saves a jump point in the guard with sigsetjmp; the
+ * SIGSEGV handler jumps back there when the faulting address is one of the guard pages of
+ * the stack the guard watches. Any other fault is left to the previous handler.
+ *
+ * @date May 4, 2025
+ */
+
+#ifndef GUARD_HPP
+#define GUARD_HPP
+
+#include <csetjmp>
+#include <csignal>
+#include <cstdint>
+#include <string_view>
+
+#include "memory.hpp"
+
+using namespace std;
+
+/**
+ * @class StackGuard
+ *
+ * Watches the stack of one machine on the current thread while it is alive. Guards may be
+ * nested; the innermost one watches. jump must be set with sigsetjmp before the guarded code
+ * runs. After the jump, error holds the error message and instruction_address the address of
+ * the native instruction that faulted. Guards are only worth building for guarded stacks.
+ */
+class StackGuard {
+    const Memory& memory;
+    StackGuard* previous;
+
+    static thread_local StackGuard* active;
+    static struct sigaction previous_action;
+
+    static void handle_fault(int signal_number, siginfo_t* info, void* context);
+    static void install();
+
+   public:
+    sigjmp_buf jump;
+    string_view error;
+    uintptr_t instruction_address = 0;
+
+    explicit StackGuard(const Memory& memory);
+    StackGuard(const StackGuard&) = delete;
+    StackGuard& operator=(const StackGuard&) = delete;
+    ~StackGuard();
+};
+
+#endif
@@ -0,0 +1,193 @@
+/**
+ * @file handlers.hpp
+ *
+ * This file defines the instruction handlers of the interpreter as one template family,
+ * specialized at compile time on the opcode and on the types of both operands. The decoder
+ * picks the specialization for an instruction once, so an executed handler never checks an
+ * operand type.
+ *
+ * @date May 4, 2025
+ */
+
+#ifndef HANDLERS_HPP
+#define HANDLERS_HPP
+
+#include <array>
+#include <iostream>
+#include <utility>
+
+#include "hardware.hpp"
+#include "instructions.hpp"
+#include "machine.hpp"
+#include "values.hpp"
+
+using namespace std;
+
+/**
+ * A handler executes one instruction, given its index in the program, and returns how many
+ * instructions to advance by, or 0 if the instruction faulted and the machine must stop.
+ */
+using Handler = size_t (*)(Machine& machine, const Instruction& instruction,
+                           size_t program_counter);
+
+/**
+ * Tells whether an opcode is valid with the given operand types, i.e. whether a specialized
+ * handler exists for it.
+ *
+ * @return bool true if execute<opcode, first, second> may be instantiated
+ */
+template <Opcode opcode, OperandType first, OperandType second>
+constexpr bool is_executable() {
+    switch (opcode) {
+        case SETv:
+        case SETr:
+        case ADDv:
+        case ADDr:
+        case SUBv:
+        case SUBr:
+            return first == REGISTER && second != NONE;
+
+        case IFNZ:
+        case PRINT:
+        case PUSH:
+        case POP:
+            return first == REGISTER;
+
+        case LOAD:
+        case STORE:
+            return first == NUMERIC && second == REGISTER;
+    }
+
+    return false;
+}
+
+/**
+ * Reads an operand whose type is known at compile time.
+ *
+ * @param registers The register file
+ * @param value The operand value: an immediate or a register ID
+ * @return uint16_t The immediate or the register value
+ */
+template <OperandType type>
+inline uint16_t read_operand(const RegistersManager& registers, const uint16_t value) {
+    if constexpr (type == REGISTER)
+        return static_cast<uint16_t>(registers[value]);
+    else
+        return value;
+}
+
+/**
+ * Executes one instruction whose opcode and operand types are known at compile time. The
+ * instruction must come from a verified program: memory addresses are not checked. Stack
+ * overflow and underflow can only be known at run time; they are recorded in machine.error,
+ * along with the program counter.
+ *
+ * @param machine The machine the instruction runs on
+ * @param instruction The instruction to execute
+ * @param program_counter The index of the instruction in the program
+ * @return size_t How many instructions to advance by: 2 when IFNZ skips, 0 on a fault, 1
+ * otherwise
+ */
+template <Opcode opcode, OperandType first, OperandType second>
+inline size_t execute(Machine& machine, const Instruction& instruction,
+                      [[maybe_unused]] const size_t program_counter) {
+    static_assert(is_executable<opcode, first, second>(), "no handler for these operand types");
+
+    RegistersManager& registers = machine.registers;
+    Memory& memory = machine.memory;
+
+    const uint16_t first_value = instruction.values[0];
+    const uint16_t second_value = instruction.values[1];
+
+    if constexpr (opcode == SETv || opcode == SETr) {
+        registers[first_value] = read_operand<second>(registers, second_value);
+    } else if constexpr (opcode == ADDv || opcode == ADDr) {
+        registers[first_value] += read_operand<second>(registers, second_value);
+    } else if constexpr (opcode == SUBv || opcode == SUBr) {
+        registers[first_value] -= read_operand<second>(registers, second_value);
+    } else if constexpr (opcode == IFNZ) {
+        return static_cast<uint16_t>(registers[first_value]) == 0 ? 2 : 1;
+    } else if constexpr (opcode == PRINT) {
+        machine.output.print(registers[first_value], program_counter);
+    } else if constexpr (opcode == PUSH) {
+        if (!memory.can_push()) {
+            machine.error = ErrorMessages::get_stack_overflow_error();
+            machine.error_program_counter = program_counter;
+            return 0;
+        }
+
+        memory.push(registers[first_value]);
+    } else if constexpr (opcode == POP) {
+        if (!memory.can_pop()) {
+            machine.error = ErrorMessages::get_stack_underflow_error();
+            machine.error_program_counter = program_counter;
+            return 0;
+        }
+
+        registers[first_value] = memory.pop();
+    } else if constexpr (opcode == LOAD) {
+        registers[second_value] = memory.load(first_value);
+    } else if constexpr (opcode == STORE) {
+        memory.store(first_value, static_cast<uint16_t>(registers[second_value]));
+    }
+
+    return 1;
+}
+
+/**
+ * Computes the dispatch table index of an opcode and its operand types.
+ *
+ * @return size_t The index into HANDLERS
+ */
+constexpr size_t get_handler_index(const Opcode opcode, const OperandType first,
+                                   const OperandType second) {
+    return (opcode * OPERAND_TYPES_NUMBER + first) * OPERAND_TYPES_NUMBER + second;
+}
+
+inline constexpr size_t HANDLERS_NUMBER = OPCODES_NUMBER * OPERAND_TYPES_NUMBER * OPERAND_TYPES_NUMBER;
+
+/**
+ * Returns the handler for one dispatch table index.
+ *
+ * @return Handler The specialized handler, or nullptr if the operand types are not valid
+ */
+template <size_t index>
+constexpr Handler build_handler() {
+    constexpr auto opcode = static_cast<Opcode>(index / (OPERAND_TYPES_NUMBER * OPERAND_TYPES_NUMBER));
+    constexpr auto first = static_cast<OperandType>(index / OPERAND_TYPES_NUMBER % OPERAND_TYPES_NUMBER);
+    constexpr auto second = static_cast<OperandType>(index % OPERAND_TYPES_NUMBER);
+
+    if constexpr (is_executable<opcode, first, second>())
+        return &execute<opcode, first, second>;
+    else
+        return nullptr;
+}
+
+/**
+ * Builds the dispatch table over every opcode and pair of operand types.
+ *
+ * @return array<Handler, HANDLERS_NUMBER> The table, indexed by get_handler_index
+ */
+template <size_t... indices>
+constexpr array<Handler, HANDLERS_NUMBER> build_handlers(index_sequence<indices...>) {
+    return {build_handler<indices>()...};
+}
+
+/**
+ * The dispatch table: a specialized handler for every valid combination of opcode and
+ * operand types, nullptr for the invalid ones.
+ */
+inline constexpr array<Handler, HANDLERS_NUMBER> HANDLERS =
+    build_handlers(make_index_sequence<HANDLERS_NUMBER>());
+
+/**
+ * Picks the specialized handler for a decoded instruction.
+ *
+ * @param instruction The decoded instruction
+ * @return Handler The handler, or nullptr if the operands do not fit the opcode
+ */
+inline Handler select_handler(const Instruction& instruction) {
+    return HANDLERS[get_handler_index(instruction.opcode, instruction.types[0], instruction.types[1])];
+}
+
+#endif
@@ -9,7 +9,6 @@
 
 #include "hardware.hpp"
 #include "software.hpp"
-#include <set>
 
 using namespace std;
 
@@ -57,28 +56,10 @@ Register::operator uint16_t() const {
 }
 
 /**
- * Creates and returns a map of registers
+ * Returns the register symbols, indexed by register ID
  * 
- * @returns unordered_map<string, Register*>: A map of registers
+ * @returns const array<string_view, REGISTERS_NUMBER>&: The register symbols
  */
-unordered_map<string, Register*>& RegistersManager::get_registers() {
-    static unordered_map<string, Register*> processor_registers_mapping = {};
-
-    if (processor_registers_mapping.empty()) {
-        for (auto symbol = REGISTERS_SYMBOLS.begin();
-             symbol != REGISTERS_SYMBOLS.end(); ++symbol) {
-            processor_registers_mapping[*symbol] = new Register();
-        }
-    }
-
-    return processor_registers_mapping;
-}
-
-/**
- * Returns the set of register symbols
- * 
- * @returns const set<string>&: A set of register symbols
- */
-const set<string>& RegistersManager::get_registers_symbols() {
+const array<string_view, RegistersManager::REGISTERS_NUMBER>& RegistersManager::get_registers_symbols() {
     return REGISTERS_SYMBOLS;
 }
@@ -13,9 +13,9 @@
 
 #include <array>
 #include <iostream>
-#include <set>
+#include <optional>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 
 using namespace std;
 
@@ -37,19 +37,67 @@ class Register {
 /**
  * @class RegistersManager
  *
- * Provides a mapping from register names to Register objects.
+ * The register file: all registers stored contiguously and addressed by register ID.
+ * Register names are resolved to IDs once, when an instruction is decoded.
  */
 class RegistersManager {
+   public:
     static constexpr int REGISTERS_NUMBER = 4;
-    static const inline set<string> REGISTERS_SYMBOLS = {"a", "b", "c", "d"};
-    array<Register, REGISTERS_NUMBER> registers;
+
+   private:
+    static constexpr array<string_view, REGISTERS_NUMBER> REGISTERS_SYMBOLS = {"a", "b", "c", "d"};
+    array<Register, REGISTERS_NUMBER> registers = {};
 
    public:
     static constexpr uint16_t PROCESSOR_REGISTER_MIN_VALUE = 0;
     static constexpr uint16_t PROCESSOR_REGISTER_MAX_VALUE =
         UINT16_MAX;  // corresponds to 1111 1111 1111 1111 (16 bits)
-    static unordered_map<string, Register*>& get_registers();
-    static const set<string>& get_registers_symbols();
+    Register& operator[](uint16_t id);
+    const Register& operator[](uint16_t id) const;
+    static const array<string_view, REGISTERS_NUMBER>& get_registers_symbols();
+    static constexpr optional<uint16_t> find_register(string_view symbol);
 };
 
+/**
+ * Looks up a register symbol. Symbols are consecutive single letters, so the register ID
+ * is the distance from the first symbol.
+ *
+ * @param symbol The register symbol.
+ * @returns optional<uint16_t>: The register ID, or nullopt if symbol is not a register
+ */
+constexpr optional<uint16_t> RegistersManager::find_register(const string_view symbol) {
+    if (symbol.size() != 1) return nullopt;
+
+    const auto id = static_cast<uint16_t>(symbol.front() - REGISTERS_SYMBOLS.front().front());
+
+    if (id >= REGISTERS_NUMBER) return nullopt;
+
+    return id;
+}
+
+/**
+ * Returns the register with the given ID. IDs come from find_register, so they are not
+ * checked again here.
+ *
+ * @param id The register ID.
+ * @returns Register&: The register
+ */
+inline Register& RegistersManager::operator[](const uint16_t id) {
+    return registers[id];
+}
+
+/**
+ * Returns the register with the given ID for reading.
+ *
+ * @param id The register ID.
+ * @returns const Register&: The register
+ */
+inline const Register& RegistersManager::operator[](const uint16_t id) const {
+    return registers[id];
+}
+
+static_assert(sizeof(Register) == sizeof(uint16_t), "registers must pack into a uint16_t array");
+static_assert(RegistersManager::find_register("a") == 0 && RegistersManager::find_register("d") == 3 &&
+              !RegistersManager::find_register("e") && !RegistersManager::find_register("A"));
+
 #endif
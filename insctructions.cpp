@@ -7,11 +7,10 @@
  * @date May 4, 2025
  */
 
-#include <algorithm>
 #include <array>
-#include <sstream>
-#include <unordered_map>
-#include <unordered_set>
+#include <charconv>
+#include <optional>
+#include <system_error>
 
 #include "hardware.hpp"
 #include "instructions.hpp"
@@ -20,53 +19,121 @@
 
 using namespace std;
 
-const unordered_map<string, Opcode> OPCODES_MAP = {
-    {"SETv", SETv}, {"SETr", SETr}, {"ADDv", ADDv},
-    {"ADDr", ADDr}, {"SUBv", SUBv}, {"SUBr", SUBr},
-    {"IFNZ", IFNZ}, {"PRINT", PRINT}, {"PUSH", PUSH},
-    {"POP", POP}, {"LOAD", LOAD}, {"STORE", STORE},
-};
+constexpr size_t OPCODES_TABLE_SIZE = 32;
+constexpr uint8_t OPCODES_TABLE_EMPTY_SLOT = UINT8_MAX;
 
 /**
- * Parses the opcode and operands from the raw string and initializes
- * the Instruction object.
+ * Hashes an opcode token of at least two characters into a slot of the opcodes table.
+ *
+ * @param token The token to hash.
+ * @param seed The multiplier that makes the hash collision free over OPCODES_NAMES.
+ * @return size_t The slot index.
+ */
+constexpr size_t hash_opcode(const string_view token, const size_t seed) {
+    return (static_cast<unsigned char>(token.front()) * seed + static_cast<unsigned char>(token[1]) +
+            static_cast<unsigned char>(token.back()) * 3 + token.size()) %
+           OPCODES_TABLE_SIZE;
+}
+
+/**
+ * Searches for the smallest seed for which hash_opcode has no collisions over OPCODES_NAMES.
+ *
+ * @return size_t The seed, or 0 if there is none.
+ */
+constexpr size_t find_opcodes_hash_seed() {
+    for (size_t seed = 1; seed < OPCODES_TABLE_SIZE * OPCODES_TABLE_SIZE; ++seed) {
+        array<bool, OPCODES_TABLE_SIZE> used = {};
+        bool perfect = true;
+
+        for (const string_view name : OPCODES_NAMES) {
+            bool& slot = used[hash_opcode(name, seed)];
+            perfect = perfect && !slot;
+            slot = true;
+        }
+
+        if (perfect) return seed;
+    }
+
+    return 0;
+}
+
+constexpr size_t OPCODES_HASH_SEED = find_opcodes_hash_seed();
+static_assert(OPCODES_HASH_SEED != 0, "opcode mnemonics have no perfect hash");
+
+/**
+ * Builds the slot -> Opcode table of the perfect hash.
+ *
+ * @return array<uint8_t, OPCODES_TABLE_SIZE> The table, OPCODES_TABLE_EMPTY_SLOT in unused slots.
+ */
+constexpr array<uint8_t, OPCODES_TABLE_SIZE> build_opcodes_table() {
+    array<uint8_t, OPCODES_TABLE_SIZE> table = {};
+    table.fill(OPCODES_TABLE_EMPTY_SLOT);
+
+    for (size_t opcode = 0; opcode < OPCODES_NUMBER; ++opcode) {
+        table[hash_opcode(OPCODES_NAMES[opcode], OPCODES_HASH_SEED)] = static_cast<uint8_t>(opcode);
+    }
+
+    return table;
+}
+
+constexpr array<uint8_t, OPCODES_TABLE_SIZE> OPCODES_TABLE = build_opcodes_table();
+
+/**
+ * Looks up an opcode token: one hash and at most one string comparison.
  *
- * @param raw The raw instruction string to parse.
+ * @param token The opcode token.
+ * @return optional<Opcode> The opcode, or nullopt if the token is not an opcode mnemonic.
  */
-Instruction::Instruction(const string& raw) : opcode(parse_opcode(raw)) {
-    operands[HardcodedValues::get_first_item_index()] =
-        operands[HardcodedValues::get_second_item_index()] = nullptr;
-    const vector<string> tokens = functools::split(raw, HardcodedValues::get_delimiter_symbol());
-    const set<string>& symbols = RegistersManager::get_registers_symbols();
-    const int items = HardcodedValues::get_several_operands_vector_size() - 1;
+constexpr optional<Opcode> find_opcode(const string_view token) {
+    if (token.size() < 2) return nullopt;
 
-    for (int i = 0; i < items; ++i) {
-        const int operand_index = HardcodedValues::get_first_operand_index() + i;
+    const uint8_t slot = OPCODES_TABLE[hash_opcode(token, OPCODES_HASH_SEED)];
 
-        if (operand_index >= static_cast<int>(tokens.size())) break;
+    if (slot == OPCODES_TABLE_EMPTY_SLOT || OPCODES_NAMES[slot] != token) return nullopt;
 
-        const string& token = tokens[operand_index];
-        Operand* operand = new Operand();
+    return static_cast<Opcode>(slot);
+}
+
+static_assert(find_opcode("PRINT") == PRINT && find_opcode("POP") == POP && !find_opcode("SETx"));
+
+/**
+ * Parses the opcode and operands from the tokens of an instruction line and initializes
+ * the Instruction object.
+ *
+ * @param tokens The tokens of the instruction line.
+ */
+Instruction::Instruction(const Tokens& tokens)
+    : opcode(parse_opcode(tokens.items[HardcodedValues::get_first_item_index()])),
+      operands_number(0),
+      types{NONE, NONE},
+      values{} {
+    for (size_t i = 0; i < MAX_OPERANDS_NUMBER; ++i) {
+        const size_t operand_index = HardcodedValues::get_first_operand_index() + i;
 
-        if (symbols.contains(token)) {
-            operand -> type   = REGISTER;
-            operand -> parsed = static_cast<uint16_t>(
-                distance(symbols.begin(), symbols.find(token)));
+        if (operand_index >= tokens.count) break;
+
+        const string_view token = tokens.items[operand_index];
+
+        if (const optional<uint16_t> id = RegistersManager::find_register(token)) {
+            types[i]  = REGISTER;
+            values[i] = *id;
         } else {
-            operand -> type   = NUMERIC;
-            operand -> parsed = static_cast<uint16_t>(stoi(token));
+            types[i]  = NUMERIC;
+            values[i] = parse_number(token).value_or(0);
         }
 
-        operands[i] = operand;
+        ++operands_number;
     }
 }
 
 /**
- * Releases memory allocated for operands.
+ * Unpacks one operand of the instruction.
+ *
+ * @param index The operand index, below operands_number.
+ * @return Operand The operand type and value.
  */
-Instruction::~Instruction() {
-    delete operands[HardcodedValues::get_first_item_index()];
-    delete operands[HardcodedValues::get_second_item_index()];
+Operand Instruction::operand(const size_t index) const {
+    return {types[index], values[index]};
 }
 
 /**
@@ -74,14 +141,49 @@ Instruction::~Instruction() {
  * enum value. If the opcode is not recognized, the program exits
  * with an error message.
  *
- * @param raw The raw instruction string to parse.
+ * @param token The opcode token to parse.
  * @return The corresponding Opcode enum value.
  */
-Opcode parse_opcode(const string& raw) {
-    string opcode = functools::split(raw, HardcodedValues::get_delimiter_symbol())[HardcodedValues::get_first_item_index()];
+Opcode parse_opcode(const string_view token) {
+    if (const optional<Opcode> opcode = find_opcode(token)) return *opcode;
 
-    if (OPCODES_MAP.contains(opcode)) return OPCODES_MAP.find(opcode) -> second;
-
-    cerr << ErrorMessages::get_unknown_opcode_error() << opcode << endl;
+    cerr << ErrorMessages::get_unknown_opcode_error() << token << endl;
     exit(ExitStatusCodes::get_failure_exit_status());
 }
+
+/**
+ * Parses an immediate value: a decimal, 0x hexadecimal or 0b binary literal. The digits are
+ * read with from_chars straight out of the token, with no locale, allocation or exception.
+ *
+ * @param token The operand token to parse.
+ * @return optional<uint16_t> The value, or nullopt if the token is not a literal or does not
+ * fit in 16 bits.
+ */
+optional<uint16_t> parse_number(const string_view token) {
+    string_view digits = token;
+    int base = 10;
+
+    if (digits.size() > 2 && digits[0] == '0') {
+        if (digits[1] == 'x' || digits[1] == 'X') base = 16;
+        if (digits[1] == 'b' || digits[1] == 'B') base = 2;
+        if (base != 10) digits.remove_prefix(2);
+    }
+
+    const char* const end = digits.data() + digits.size();
+    uint16_t value = 0;
+    const from_chars_result result = from_chars(digits.data(), end, value, base);
+
+    if (result.ec != errc() || result.ptr != end) return nullopt;
+
+    return value;
+}
+
+/**
+ * Checks whether a token names an opcode, without reporting anything.
+ *
+ * @param token The token to check.
+ * @return bool true if the token is an opcode mnemonic.
+ */
+bool is_opcode(const string_view token) {
+    return find_opcode(token).has_value();
+}
@@ -14,18 +14,28 @@
 #ifndef INSTRUCTIONS_HPP
 #define INSTRUCTIONS_HPP
 
+#include <array>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 
 using namespace std;
 
+struct Tokens;
+class MappedFile;
+
 /**
  * @enum Opcode
  *
  * Opcodes with 'v' suffix operate on immediate values, while those with 'r' suffix
  * operate on values from registers.
  */
-enum Opcode {
+enum Opcode : uint8_t {
     SETv,
     SETr,
     ADDv,
@@ -40,17 +50,31 @@ enum Opcode {
     STORE,
 };
 
+inline constexpr size_t OPCODES_NUMBER = STORE + 1;
+
+/**
+ * Opcode mnemonics as they are written in program files, indexed by Opcode.
+ */
+inline constexpr array<string_view, OPCODES_NUMBER> OPCODES_NAMES = {
+    "SETv", "SETr", "ADDv", "ADDr", "SUBv", "SUBr",
+    "IFNZ", "PRINT", "PUSH", "POP", "LOAD", "STORE",
+};
+
 /**
  * @enum OperandType
  *
  * This enum is used to differentiate between immediate values and register names.
  * The 'NUMERIC' type indicates an immediate value, while 'REGISTER' indicates a register value.
+ * 'NONE' marks an operand the instruction was written without.
  */
-enum OperandType {
+enum OperandType : uint8_t {
     NUMERIC,
     REGISTER,
+    NONE,
 };
 
+inline constexpr size_t OPERAND_TYPES_NUMBER = NONE + 1;
+
 /**
  * @struct Operand
  *
@@ -64,22 +88,104 @@ struct Operand {
 /**
  * @struct Instruction
  *
- * Each instruction consists of an opcode and zero or more operands.
+ * Each instruction consists of an opcode and zero or more operands. Operands are stored
+ * inline, split into their types and values, so that an instruction packs into 8 bytes and
+ * can be copied as plain bytes.
  */
 struct Instruction {
-    const Opcode opcode;
-    const Operand* operands[2];
+    static constexpr size_t MAX_OPERANDS_NUMBER = 2;
+
+    Opcode opcode;
+    uint8_t operands_number;
+    OperandType types[MAX_OPERANDS_NUMBER];
+    uint16_t values[MAX_OPERANDS_NUMBER];
+
+    Instruction() = default;
+    Instruction(const Tokens& tokens);
 
-    Instruction(const string& raw);
-    ~Instruction();
+    Operand operand(size_t index) const;
 };
 
+static_assert(sizeof(Instruction) == 8 && is_trivially_copyable_v<Instruction>,
+              "decoded instructions must stay packed and copyable as plain bytes");
+
 /**
- * Parses an opcode from a raw instruction string.
+ * @struct Program
+ *
+ * A decoded program: every instruction of a program file, in source order, stored
+ * contiguously so that execution never has to go back to the program text. The source line
+ * of each instruction is kept aside for error messages. A verified program has passed
+ * functools::verify for a memory of memory_size bytes, and may be executed without any
+ * runtime validation on a machine with at least that much memory.
  *
- * @param raw The raw instruction string to parse.
+ * The instructions and lines are views: into the decoded vectors for a program decoded from
+ * text, or straight into the mapped file for a bytecode program, which the program keeps
+ * mapped. No lines means every instruction is on the line after the previous one. A program
+ * can be moved but not copied, so that its views never outlive what they point to.
+ */
+struct Program {
+    span<const Instruction> instructions;
+    span<const size_t> lines;
+    bool verified = false;
+    size_t memory_size = 0;
+
+    vector<Instruction> decoded_instructions;
+    vector<size_t> decoded_lines;
+    shared_ptr<const MappedFile> mapping;
+
+    Program() = default;
+    Program(const Program&) = delete;
+    Program& operator=(const Program&) = delete;
+    Program(Program&&) = default;
+    Program& operator=(Program&&) = default;
+
+    size_t get_line(size_t index) const;
+    bool is_verified_for(size_t machine_memory_size) const;
+};
+
+/**
+ * Returns the source line of an instruction.
+ *
+ * @param index The index of the instruction in the program.
+ * @return size_t The 1-based line the instruction was written on.
+ */
+inline size_t Program::get_line(const size_t index) const {
+    return lines.empty() ? index + 1 : lines[index];
+}
+
+/**
+ * Tells whether the program may run unchecked on a machine: every address it uses must be
+ * inside the memory of the machine.
+ *
+ * @param machine_memory_size The memory size of the machine, in bytes.
+ * @return bool true if the program was verified for that much memory or less.
+ */
+inline bool Program::is_verified_for(const size_t machine_memory_size) const {
+    return verified && memory_size <= machine_memory_size;
+}
+
+/**
+ * Parses an opcode from its token.
+ *
+ * @param token The opcode token to parse.
  * @return Opcode The parsed opcode.
  */
-Opcode parse_opcode(const string& raw);
+Opcode parse_opcode(string_view token);
+
+/**
+ * Parses an immediate value: a decimal, 0x hexadecimal or 0b binary literal.
+ *
+ * @param token The operand token to parse.
+ * @return optional<uint16_t> The value, or nullopt if the token is not a uint16 literal.
+ */
+optional<uint16_t> parse_number(string_view token);
+
+/**
+ * Tells whether a token is an opcode mnemonic.
+ *
+ * @param token The token to check.
+ * @return bool true if parse_opcode accepts the token.
+ */
+bool is_opcode(string_view token);
 
 #endif
@@ -0,0 +1,488 @@
+/**
+ * @file jit.cpp
+ *
+ * This file implements the x86-64 JIT compiler. The generated code follows the System V
+ * calling convention and keeps the simulator state in callee-saved registers, so that calls
+ * back into the simulator do not have to spill anything:
+ *  - rbx: the JitContext pointer
+ *  - rbp: the Memory buffer
+ *  - r12d-r15d: registers a-d, zero-extended to 32 bits
+ *
+ * ADD and SUB are done on the 16-bit halves, so the carry flag tells whether the result has
+ * to be clamped, which is done without branches: 'sbb eax, eax' turns the carry into an
+ * all-ones or all-zeros mask that is OR-ed into (ADD) or, inverted, AND-ed into (SUB) the
+ * register. IFNZ becomes a forward 'jz' over the code of the next instruction.
+ *
+ * On a guarded stack, PUSH and POP are inlined: they move the stack top kept in the
+ * JitContext without any bounds check, and a fault on a guard page is caught by the
+ * StackGuard of run, which finds the faulting instruction from the address of the native
+ * code. Otherwise they call back into the simulator, which leaves the native code through
+ * the jump point of the JitContext on a fault, and no StackGuard is needed.
+ *
+ * @date May 4, 2025
+ */
+
+#include "jit.hpp"
+
+#include <algorithm>
+#include <csetjmp>
+#include <cstring>
+#include <iostream>
+#include <optional>
+
+#include "values.hpp"
+
+#if defined(__x86_64__)
+#include <sys/mman.h>
+#endif
+
+using namespace std;
+
+/**
+ * @struct JitContext
+ *
+ * What the generated code receives in rdi. Field offsets are hardcoded in the prologue and
+ * epilogue.
+ */
+struct JitContext {
+    uint16_t* registers;
+    uint8_t* memory;
+    Machine* machine;
+    uint16_t* stack_top;
+    jmp_buf exit;
+};
+
+#if defined(__x86_64__)
+
+constexpr uint8_t FIRST_REGISTER_ENCODING = 12;  // r12
+static_assert(RegistersManager::REGISTERS_NUMBER == 4, "registers a-d are mapped onto r12-r15");
+constexpr uint8_t RAX_ENCODING = 0;
+constexpr uint8_t RSI_ENCODING = 6;
+constexpr uint8_t OPERAND_SIZE_PREFIX = 0x66;
+constexpr uint8_t REX = 0x40;
+constexpr uint8_t REX_R = 0x04;
+constexpr uint8_t REX_B = 0x01;
+
+/**
+ * Calls made by the generated code for PRINT, PUSH and POP
+ */
+void jit_print(const JitContext* context, const uint32_t value, const uint32_t program_counter) {
+    context -> machine -> output.print(static_cast<uint16_t>(value), program_counter);
+}
+
+// Native code cannot stop halfway, so a stack fault leaves it through the exit of run
+void jit_push(JitContext* context, const uint32_t value, const uint32_t program_counter) {
+    if (!context -> machine -> memory.can_push()) {
+        context -> machine -> error = ErrorMessages::get_stack_overflow_error();
+        context -> machine -> error_program_counter = program_counter;
+        longjmp(context -> exit, 1);
+    }
+
+    context -> machine -> memory.push(static_cast<uint16_t>(value));
+}
+
+uint32_t jit_pop(JitContext* context, const uint32_t program_counter) {
+    if (!context -> machine -> memory.can_pop()) {
+        context -> machine -> error = ErrorMessages::get_stack_underflow_error();
+        context -> machine -> error_program_counter = program_counter;
+        longjmp(context -> exit, 1);
+    }
+
+    return context -> machine -> memory.pop();
+}
+
+/**
+ * Returns the machine register that holds a simulator register
+ *
+ * @param id The register ID
+ * @return uint8_t The x86-64 register encoding
+ */
+uint8_t get_machine_register(const uint16_t id) {
+    return static_cast<uint8_t>(FIRST_REGISTER_ENCODING + id);
+}
+
+/**
+ * Encodes a ModRM byte
+ *
+ * @param mod The addressing mode
+ * @param reg The register (or opcode extension) field
+ * @param rm The register/memory field
+ * @return uint8_t The ModRM byte
+ */
+uint8_t modrm(const uint8_t mod, const uint8_t reg, const uint8_t rm) {
+    return static_cast<uint8_t>((mod << 6) | ((reg & 7) << 3) | (rm & 7));
+}
+
+/**
+ * Encodes a REX prefix for a register-to-register instruction
+ *
+ * @param reg The register in the ModRM reg field
+ * @param rm The register in the ModRM rm field
+ * @return uint8_t The REX prefix
+ */
+uint8_t rex(const uint8_t reg, const uint8_t rm) {
+    return static_cast<uint8_t>(REX | (reg >= 8 ? REX_R : 0) | (rm >= 8 ? REX_B : 0));
+}
+
+/**
+ * Appends bytes to the code
+ */
+void emit(vector<uint8_t>& code, const initializer_list<uint8_t> bytes) {
+    code.insert(code.end(), bytes);
+}
+
+/**
+ * Appends a little-endian immediate to the code
+ */
+template <typename Immediate>
+void emit_immediate(vector<uint8_t>& code, const Immediate value) {
+    uint8_t bytes[sizeof(Immediate)];
+    memcpy(bytes, &value, sizeof(Immediate));
+    code.insert(code.end(), bytes, bytes + sizeof(Immediate));
+}
+
+/**
+ * Emits 'mov rdi, rbx; mov rax, function; call rax', with the value of a simulator register
+ * in esi if value_register is given
+ */
+void emit_call(vector<uint8_t>& code, const void* function, const int value_register = -1) {
+    emit(code, {0x48, 0x89, 0xDF});  // mov rdi, rbx
+
+    if (value_register >= 0) {
+        const auto source = static_cast<uint8_t>(value_register);
+        emit(code, {rex(source, RSI_ENCODING), 0x89, modrm(3, source, RSI_ENCODING)});
+    }
+
+    emit(code, {0x48, 0xB8});  // mov rax, imm64
+    emit_immediate(code, reinterpret_cast<uint64_t>(function));
+    emit(code, {0xFF, 0xD0});  // call rax
+}
+
+/**
+ * Emits the clamping of a register after a 16-bit ADD (to 0xFFFF) or SUB (to 0) that may
+ * have carried
+ */
+void emit_saturation(vector<uint8_t>& code, const uint8_t destination, const bool is_addition) {
+    emit(code, {0x19, 0xC0});  // sbb eax, eax
+
+    if (!is_addition) emit(code, {0xF7, 0xD0});  // not eax
+
+    // or/and r16, ax
+    emit(code, {OPERAND_SIZE_PREFIX, rex(RAX_ENCODING, destination),
+                static_cast<uint8_t>(is_addition ? 0x09 : 0x21), modrm(3, RAX_ENCODING, destination)});
+}
+
+/**
+ * Emits a saturating 16-bit ADD or SUB of an immediate or a register
+ */
+void emit_arithmetic(vector<uint8_t>& code, const Instruction& instruction, const bool is_addition) {
+    const uint8_t destination = get_machine_register(instruction.values[0]);
+
+    if (instruction.types[1] == NUMERIC) {
+        // add/sub r16, imm16
+        emit(code, {OPERAND_SIZE_PREFIX, rex(0, destination), 0x81,
+                    modrm(3, is_addition ? 0 : 5, destination)});
+        emit_immediate(code, instruction.values[1]);
+    } else {
+        // add/sub r16, r16
+        const uint8_t source = get_machine_register(instruction.values[1]);
+        emit(code, {OPERAND_SIZE_PREFIX, rex(source, destination),
+                    static_cast<uint8_t>(is_addition ? 0x01 : 0x29), modrm(3, source, destination)});
+    }
+
+    emit_saturation(code, destination, is_addition);
+}
+
+/**
+ * Tells whether the JIT can compile the program: it must be verified, and every opcode
+ * must have a native translation
+ *
+ * @param program The program to compile
+ * @return bool true if the program can be compiled
+ */
+bool JitProgram::is_supported(const Program& program) {
+    if (!program.verified) return false;
+
+    for (const Instruction& instruction : program.instructions) {
+        switch (instruction.opcode) {
+            case SETv:
+            case SETr:
+            case ADDv:
+            case ADDr:
+            case SUBv:
+            case SUBr:
+            case IFNZ:
+            case PRINT:
+            case PUSH:
+            case POP:
+            case LOAD:
+            case STORE:
+                break;
+
+            default:
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Compiles the program into an executable buffer
+ *
+ * @param program A program for which is_supported is true
+ * @param is_stack_guarded Whether the program will run on a guarded stack, so that PUSH and
+ * POP can be inlined
+ */
+JitProgram::JitProgram(const Program& program, const bool is_stack_guarded)
+    : is_stack_guarded(is_stack_guarded), offsets(program.instructions.size() + 1) {
+    const span<const Instruction> instructions = program.instructions;
+    vector<uint8_t> buffer;
+    vector<pair<size_t, size_t>> skips;  // rel32 position, target instruction
+
+    emit_prologue(buffer);
+
+    for (size_t i = 0; i < instructions.size(); ++i) {
+        offsets[i] = buffer.size();
+
+        if (instructions[i].opcode == IFNZ) {
+            const uint8_t tested = get_machine_register(instructions[i].values[0]);
+            emit(buffer, {rex(tested, tested), 0x85, modrm(3, tested, tested)});  // test r32, r32
+            emit(buffer, {0x0F, 0x84});                                            // jz rel32
+            skips.emplace_back(buffer.size(), min(i + 2, instructions.size()));
+            emit_immediate(buffer, int32_t{0});
+        } else {
+            emit_instruction(buffer, instructions[i], i, is_stack_guarded);
+        }
+    }
+
+    offsets[instructions.size()] = buffer.size();
+    emit_epilogue(buffer);
+
+    for (const auto& [position, target] : skips) {
+        const auto displacement = static_cast<int32_t>(offsets[target] - (position + sizeof(int32_t)));
+        memcpy(buffer.data() + position, &displacement, sizeof(int32_t));
+    }
+
+    code_size = buffer.size();
+    void* mapping = mmap(nullptr, code_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (mapping == MAP_FAILED) {
+        cerr << ErrorMessages::get_jit_allocation_error() << endl;
+        exit(ExitStatusCodes::get_failure_exit_status());
+    }
+
+    memcpy(mapping, buffer.data(), code_size);
+
+    if (mprotect(mapping, code_size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(mapping, code_size);
+        cerr << ErrorMessages::get_jit_allocation_error() << endl;
+        exit(ExitStatusCodes::get_failure_exit_status());
+    }
+
+    code = static_cast<uint8_t*>(mapping);
+}
+
+/**
+ * Releases the executable buffer
+ */
+JitProgram::~JitProgram() {
+    if (code != nullptr) munmap(code, code_size);
+}
+
+/**
+ * Runs the compiled program on the given machine. A stack fault stops it with machine.error
+ * set.
+ *
+ * @param machine The machine to run on; its registers are updated when the program ends
+ */
+void JitProgram::run(Machine& machine) const {
+    array<uint16_t, RegistersManager::REGISTERS_NUMBER> values;
+
+    for (uint16_t id = 0; id < values.size(); ++id) values[id] = machine.registers[id];
+
+    JitContext context = {values.data(), machine.memory.data(), &machine,
+                          machine.memory.get_stack_top(), {}};
+    optional<StackGuard> guard;
+
+    if (is_stack_guarded) {
+        guard.emplace(machine.memory);
+
+        // A fault on a guard page happened in the inlined code of some instruction
+        if (sigsetjmp(guard -> jump, 1) != 0) {
+            const auto offset = static_cast<size_t>(guard -> instruction_address -
+                                                    reinterpret_cast<uintptr_t>(code));
+            machine.error = guard -> error;
+            machine.error_program_counter =
+                static_cast<size_t>(upper_bound(offsets.begin(), offsets.end(), offset) -
+                                    offsets.begin()) - 1;
+            return;
+        }
+    } else if (setjmp(context.exit) != 0) {
+        // jit_push or jit_pop already set the error
+        return;
+    }
+
+    reinterpret_cast<void (*)(JitContext*)>(code)(&context);
+
+    if (is_stack_guarded) machine.memory.set_stack_top(context.stack_top);
+
+    for (uint16_t id = 0; id < values.size(); ++id) machine.registers[id] = values[id];
+}
+
+/**
+ * Emits the code that saves the callee-saved registers and loads the simulator state
+ *
+ * @param code The code buffer
+ */
+void JitProgram::emit_prologue(vector<uint8_t>& code) {
+    emit(code, {0x53, 0x55, 0x41, 0x54, 0x41, 0x55, 0x41, 0x56, 0x41, 0x57});  // push rbx..r15
+    emit(code, {0x48, 0x83, 0xEC, 0x08});  // sub rsp, 8: keep calls 16-byte aligned
+    emit(code, {0x48, 0x89, 0xFB});        // mov rbx, rdi
+    emit(code, {0x48, 0x8B, 0x6B, static_cast<uint8_t>(offsetof(JitContext, memory))});     // mov rbp, [rbx + memory]
+    emit(code, {0x48, 0x8B, 0x43, static_cast<uint8_t>(offsetof(JitContext, registers))});  // mov rax, [rbx + registers]
+
+    for (uint16_t id = 0; id < RegistersManager::REGISTERS_NUMBER; ++id) {
+        const uint8_t destination = get_machine_register(id);
+        // movzx r32, word [rax + disp8]
+        emit(code, {rex(destination, RAX_ENCODING), 0x0F, 0xB7, modrm(1, destination, RAX_ENCODING),
+                    static_cast<uint8_t>(id * sizeof(uint16_t))});
+    }
+}
+
+/**
+ * Emits the code that writes the simulator registers back and returns
+ *
+ * @param code The code buffer
+ */
+void JitProgram::emit_epilogue(vector<uint8_t>& code) {
+    emit(code, {0x48, 0x8B, 0x43, static_cast<uint8_t>(offsetof(JitContext, registers))});  // mov rax, [rbx + registers]
+
+    for (uint16_t id = 0; id < RegistersManager::REGISTERS_NUMBER; ++id) {
+        const uint8_t source = get_machine_register(id);
+        // mov word [rax + disp8], r16
+        emit(code, {OPERAND_SIZE_PREFIX, rex(source, RAX_ENCODING), 0x89,
+                    modrm(1, source, RAX_ENCODING), static_cast<uint8_t>(id * sizeof(uint16_t))});
+    }
+
+    emit(code, {0x48, 0x83, 0xC4, 0x08});                                        // add rsp, 8
+    emit(code, {0x41, 0x5F, 0x41, 0x5E, 0x41, 0x5D, 0x41, 0x5C, 0x5D, 0x5B});  // pop r15..rbx
+    emit(code, {0xC3});                                                          // ret
+}
+
+/**
+ * Emits the native code of one instruction other than IFNZ
+ *
+ * @param code The code buffer
+ * @param instruction A verified instruction
+ * @param program_counter The index of the instruction in the program
+ * @param is_stack_guarded Whether PUSH and POP may skip the bounds checks of the stack
+ */
+void JitProgram::emit_instruction(vector<uint8_t>& code, const Instruction& instruction,
+                                  const size_t program_counter, const bool is_stack_guarded) {
+    const auto stack_top = static_cast<uint8_t>(offsetof(JitContext, stack_top));
+    const uint8_t first = get_machine_register(instruction.values[0]);
+    const uint8_t second = get_machine_register(instruction.values[1]);
+
+    switch (instruction.opcode) {
+        case SETv:
+        case SETr:
+            if (instruction.types[1] == NUMERIC) {
+                emit(code, {rex(0, first), static_cast<uint8_t>(0xB8 + (first & 7))});  // mov r32, imm32
+                emit_immediate(code, uint32_t{instruction.values[1]});
+            } else {
+                emit(code, {rex(second, first), 0x89, modrm(3, second, first)});  // mov r32, r32
+            }
+            break;
+
+        case ADDv:
+        case ADDr:
+            emit_arithmetic(code, instruction, true);
+            break;
+
+        case SUBv:
+        case SUBr:
+            emit_arithmetic(code, instruction, false);
+            break;
+
+        case PRINT:
+            emit(code, {0xBA});  // mov edx, imm32
+            emit_immediate(code, static_cast<uint32_t>(program_counter));
+            emit_call(code, reinterpret_cast<const void*>(&jit_print), first);
+            break;
+
+        case PUSH:
+            if (is_stack_guarded) {
+                emit(code, {0x48, 0x8B, 0x43, stack_top});  // mov rax, [rbx + stack_top]
+                // mov word [rax], r16
+                emit(code, {OPERAND_SIZE_PREFIX, rex(first, RAX_ENCODING), 0x89,
+                            modrm(0, first, RAX_ENCODING)});
+                // add qword [rbx + stack_top], 2
+                emit(code, {0x48, 0x83, 0x43, stack_top, sizeof(uint16_t)});
+                break;
+            }
+
+            emit(code, {0xBA});  // mov edx, imm32
+            emit_immediate(code, static_cast<uint32_t>(program_counter));
+            emit_call(code, reinterpret_cast<const void*>(&jit_push), first);
+            break;
+
+        case POP:
+            if (is_stack_guarded) {
+                emit(code, {0x48, 0x8B, 0x43, stack_top});  // mov rax, [rbx + stack_top]
+                emit(code, {0x48, 0x83, 0xE8, sizeof(uint16_t)});  // sub rax, 2
+                // movzx r32, word [rax]
+                emit(code, {rex(first, RAX_ENCODING), 0x0F, 0xB7, modrm(0, first, RAX_ENCODING)});
+                emit(code, {0x48, 0x89, 0x43, stack_top});  // mov [rbx + stack_top], rax
+                break;
+            }
+
+            emit(code, {0xBE});  // mov esi, imm32
+            emit_immediate(code, static_cast<uint32_t>(program_counter));
+            emit_call(code, reinterpret_cast<const void*>(&jit_pop));
+            emit(code, {rex(first, RAX_ENCODING), 0x0F, 0xB7, modrm(3, first, RAX_ENCODING)});  // movzx r32, ax
+            break;
+
+        case LOAD:
+            // movzx r32, word [rbp + disp32]
+            emit(code, {rex(second, 5), 0x0F, 0xB7, modrm(2, second, 5)});
+            emit_immediate(code, uint32_t{instruction.values[0]});
+            break;
+
+        case STORE:
+            // mov word [rbp + disp32], r16
+            emit(code, {OPERAND_SIZE_PREFIX, rex(second, 5), 0x89, modrm(2, second, 5)});
+            emit_immediate(code, uint32_t{instruction.values[0]});
+            break;
+
+        case IFNZ:
+            break;
+    }
+}
+
+#else
+
+/**
+ * Tells whether the JIT can compile the program. There is no native backend for this
+ * architecture, so programs always run on the interpreter.
+ *
+ * @param program The program to compile
+ * @return bool Always false
+ */
+bool JitProgram::is_supported(const Program& program) {
+    (void)program;
+    return false;
+}
+
+JitProgram::JitProgram(const Program& program, const bool is_stack_guarded)
+    : is_stack_guarded(is_stack_guarded) {
+    (void)program;
+}
+
+JitProgram::~JitProgram() {}
+
+void JitProgram::run(Machine& machine) const {
+    (void)machine;
+}
+
+#endif
@@ -0,0 +1,54 @@
+/**
+ * @file jit.hpp
+ *
+ * This file declares the JIT compiler, which translates a verified program into native
+ * x86-64 code. Registers a-d live in machine registers for the whole run, ADD/SUB keep the
+ * saturating semantics of the Register class, and LOAD/STORE address the Memory buffer
+ * directly. PRINT calls back into the simulator, and so do PUSH and POP unless the stack is
+ * guarded, in which case they are inlined.
+ *
+ * @date May 4, 2025
+ */
+
+#ifndef JIT_HPP
+#define JIT_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "guard.hpp"
+#include "instructions.hpp"
+#include "machine.hpp"
+
+using namespace std;
+
+/**
+ * @class JitProgram
+ *
+ * A program compiled into an executable buffer. The buffer is mapped writable while the
+ * code is emitted and executable, but no longer writable, afterwards.
+ */
+class JitProgram {
+    uint8_t* code = nullptr;
+    size_t code_size = 0;
+    bool is_stack_guarded = false;
+    vector<size_t> offsets;  // where the code of every instruction starts, then its end
+
+    // Code emission methods
+    static void emit_instruction(vector<uint8_t>& code, const Instruction& instruction,
+                                 size_t program_counter, bool is_stack_guarded);
+    static void emit_prologue(vector<uint8_t>& code);
+    static void emit_epilogue(vector<uint8_t>& code);
+
+   public:
+    static bool is_supported(const Program& program);
+
+    explicit JitProgram(const Program& program, bool is_stack_guarded = false);
+    JitProgram(const JitProgram&) = delete;
+    JitProgram& operator=(const JitProgram&) = delete;
+    ~JitProgram();
+
+    void run(Machine& machine) const;
+};
+
+#endif
@@ -0,0 +1,81 @@
+/**
+ * @file loader.cpp
+ *
+ * This file implements the memory mapping of program files.
+ *
+ * @date May 4, 2025
+ */
+
+#include "loader.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+/**
+ * Maps a file into memory. The file descriptor is closed right away, the mapping stays.
+ *
+ * @param path The path to the file
+ */
+MappedFile::MappedFile(const string& path) {
+    const int descriptor = open(path.c_str(), O_RDONLY);
+
+    if (descriptor < 0) return;
+
+    struct stat status;
+
+    if (fstat(descriptor, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0) {
+        const auto file_size = static_cast<size_t>(status.st_size);
+        void* const mapping = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+        if (mapping != MAP_FAILED) {
+            madvise(mapping, file_size, MADV_SEQUENTIAL);
+            data = static_cast<const char*>(mapping);
+            size = file_size;
+        }
+    }
+
+    close(descriptor);
+}
+
+/**
+ * Destructor for the MappedFile class. Unmaps the file.
+ */
+MappedFile::~MappedFile() {
+    if (data != nullptr) munmap(const_cast<char*>(data), size);
+}
+
+/**
+ * Tells whether the file could be mapped
+ *
+ * @return bool: true if get_text holds the file contents
+ */
+bool MappedFile::is_mapped() const {
+    return data != nullptr;
+}
+
+/**
+ * Returns the contents of the mapped file
+ *
+ * @return string_view: The whole file
+ */
+string_view MappedFile::get_text() const {
+    return {data, size};
+}
+
+/**
+ * Looks up a program loader by its name
+ *
+ * @param name The loader name: parallel, mmap or stream
+ * @return optional<ProgramLoader>: The loader, or nullopt if the name is unknown
+ */
+optional<ProgramLoader> MappedFile::find_loader(const string_view name) {
+    for (size_t loader = 0; loader < PROGRAM_LOADERS_NAMES.size(); ++loader) {
+        if (PROGRAM_LOADERS_NAMES[loader] == name) return static_cast<ProgramLoader>(loader);
+    }
+
+    return nullopt;
+}
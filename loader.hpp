@@ -0,0 +1,78 @@
+/**
+ * @file loader.hpp
+ *
+ * This file declares how program files are read before they are decoded. By default a
+ * program file is mapped into memory and decoded straight out of the mapping, without
+ * copying any line, split into newline-aligned chunks that are decoded on all cores. The mmap
+ * loader decodes the mapping on one thread, and the stream loader reads the file with getline
+ * instead; it is kept for files that cannot be mapped and for comparison.
+ *
+ * @date May 4, 2025
+ */
+
+#ifndef LOADER_HPP
+#define LOADER_HPP
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "values.hpp"
+
+using namespace std;
+
+/**
+ * @enum ProgramLoader
+ *
+ * How a program file is read: mapped into memory and decoded on all cores or on one, or
+ * through an ifstream with getline.
+ */
+enum ProgramLoader : uint8_t {
+    LOADER_PARALLEL,
+    LOADER_MMAP,
+    LOADER_STREAM,
+};
+
+inline constexpr array<string_view, LOADER_STREAM + 1> PROGRAM_LOADERS_NAMES = {"parallel", "mmap",
+                                                                               "stream"};
+
+/**
+ * @struct LoadOptions
+ *
+ * How to load a program file, whether to report the load throughput, the directory of the
+ * decoded-program cache, if any, and the memory and stack sizes of the machines the program
+ * will run on. Its addresses are verified against the memory size.
+ */
+struct LoadOptions {
+    ProgramLoader loader = LOADER_PARALLEL;
+    bool is_report = false;
+    string cache_directory;
+    size_t memory_size = HardcodedValues::get_memory_size();
+    size_t stack_size = HardcodedValues::get_stack_size();
+};
+
+/**
+ * @class MappedFile
+ *
+ * A read-only private mapping of a whole file, advised for sequential access. Files that
+ * cannot be mapped, like pipes and empty files, are left unmapped.
+ */
+class MappedFile {
+    const char* data = nullptr;
+    size_t size = 0;
+
+   public:
+    explicit MappedFile(const string& path);
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    bool is_mapped() const;
+    string_view get_text() const;
+
+    static optional<ProgramLoader> find_loader(string_view name);
+};
+
+#endif
@@ -0,0 +1,51 @@
+/**
+ * @file machine.hpp
+ *
+ * This file defines the Machine class, which owns the whole state of one simulated
+ * processor: its register file and its memory, stack pointer included. Nothing about a
+ * running program is global, so any number of machines may run in one process, each on
+ * its own thread. What a machine prints goes to its own output buffer, and a fault that
+ * stops it is recorded on the machine rather than ending the process.
+ *
+ * @date May 4, 2025
+ */
+
+#ifndef MACHINE_HPP
+#define MACHINE_HPP
+
+#include <iostream>
+#include <string_view>
+
+#include "hardware.hpp"
+#include "memory.hpp"
+#include "output.hpp"
+#include "values.hpp"
+
+using namespace std;
+
+/**
+ * @class Machine
+ *
+ * One independent virtual processor. A machine starts with zeroed registers and an empty
+ * stack; it is not copyable, since its memory is not. PRINT writes to output. error is empty
+ * while the machine runs and holds the error message once a fault has stopped it;
+ * error_program_counter is then the index of the faulting instruction.
+ */
+class Machine {
+   public:
+    RegistersManager registers;
+    Memory memory;
+    OutputBuffer output;
+    string_view error;
+    size_t error_program_counter = 0;
+
+    explicit Machine(ostream& stream = cout, FlushPolicy policy = FLUSH_ON_THRESHOLD,
+                     OutputFormat format = OUTPUT_TEXT,
+                     size_t memory_size = HardcodedValues::get_memory_size(),
+                     size_t stack_size = HardcodedValues::get_stack_size())
+        : memory(memory_size, stack_size), output(stream, policy, format) {}
+    Machine(const Machine&) = delete;
+    Machine& operator=(const Machine&) = delete;
+};
+
+#endif
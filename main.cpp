@@ -28,31 +28,280 @@
  * Memory operations (LOAD and STORE) interact with a simulated memory module,
  * while stack operations (PUSH and POP) are performed with appropriate boundary checks.
  *
+ * With --jit, the program is compiled to native x86-64 code before it runs. With
+ * --instances, the program runs once per memory image of the given file, in SIMD lanes. With
+ * --batch, every program of a list file or directory runs on a work-stealing pool of worker
+ * threads; --workers-report then reports how busy each worker was. --flush picks when printed
+ * values are written out: once at the end, every 64 KiB, or after every value.
+ * --output-format writes them as decimal text or as little-endian binary records, and
+ * --output writes them to a file instead of stdout. --loader picks whether the program file is
+ * memory-mapped or read line by line with getline, and --load-report reports how fast it was
+ * loaded. --assemble writes the decoded program to a .up3k bytecode file, which runs like a
+ * program file without being parsed again, and --disassemble writes a program back as text.
+ * --cache keeps such bytecode for every program text loaded, in the given directory, and
+ * loads it instead of the text the next time. --memory-size gives every machine up to 64 KiB
+ * of memory instead of 256 bytes, and --stack-size a deeper stack than 8 values. With
+ * --prefix, the given program runs once and every program file then runs from the state it
+ * left the machine in, restored from a copy-on-write snapshot.
+ *
  * @date May 4, 2025
  */
 
+#include <charconv>
+#include <fstream>
 #include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
 
+#include "loader.hpp"
+#include "machine.hpp"
+#include "output.hpp"
 #include "software.hpp"
 #include "values.hpp"
 
 using namespace std;
 
+/**
+ * Reports a command-line argument that cannot be used and exits
+ *
+ * @param error_message The error to report
+ * @param argument The argument
+ * @returns void
+ */
+[[noreturn]] void exit_with_argument_error(const string_view error_message,
+                                           const string_view argument) {
+    cerr << error_message << argument << endl;
+    exit(ExitStatusCodes::get_failure_exit_status());
+}
+
+/**
+ * Takes the value of the flag at index, exiting if it is the last argument
+ *
+ * @param argc Number of command-line arguments
+ * @param argv Array of command-line arguments
+ * @param index The index of the flag, moved to its value
+ * @returns const char* The value
+ */
+const char* get_flag_value(const int argc, const char** argv, int& index) {
+    if (index + 1 >= argc)
+        exit_with_argument_error(ErrorMessages::get_missing_flag_value_error(), argv[index]);
+
+    return argv[++index];
+}
+
+/**
+ * Parses the value of the --flush flag, exiting if it names no policy
+ *
+ * @param name The policy name
+ * @returns FlushPolicy The policy
+ */
+FlushPolicy parse_flush_policy(const string_view name) {
+    if (const optional<FlushPolicy> policy = OutputBuffer::find_policy(name)) return *policy;
+
+    cerr << ErrorMessages::get_unknown_flush_policy_error() << name << endl;
+    exit(ExitStatusCodes::get_failure_exit_status());
+}
+
+/**
+ * Parses the value of the --output-format flag, exiting if it names no format
+ *
+ * @param name The format name
+ * @returns OutputFormat The format
+ */
+OutputFormat parse_output_format(const string_view name) {
+    if (const optional<OutputFormat> format = OutputBuffer::find_format(name)) return *format;
+
+    cerr << ErrorMessages::get_unknown_output_format_error() << name << endl;
+    exit(ExitStatusCodes::get_failure_exit_status());
+}
+
+/**
+ * Parses the value of the --loader flag, exiting if it names no loader
+ *
+ * @param name The loader name
+ * @returns ProgramLoader The loader
+ */
+ProgramLoader parse_loader(const string_view name) {
+    if (const optional<ProgramLoader> loader = MappedFile::find_loader(name)) return *loader;
+
+    cerr << ErrorMessages::get_unknown_loader_error() << name << endl;
+    exit(ExitStatusCodes::get_failure_exit_status());
+}
+
+/**
+ * Parses the value of the --memory-size or --stack-size flag, exiting if it is not a valid size
+ *
+ * @param value The size in bytes, in decimal
+ * @param is_valid Tells whether a machine can have that size
+ * @param error_message The error to report for an invalid size
+ * @returns size_t The size
+ */
+size_t parse_size(const string_view value, bool (*const is_valid)(size_t),
+                  const string_view error_message) {
+    size_t size = 0;
+    const char* const end = value.data() + value.size();
+    const from_chars_result result = from_chars(value.data(), end, size);
+
+    if (result.ec == errc() && result.ptr == end && is_valid(size)) return size;
+
+    cerr << error_message << value << endl;
+    exit(ExitStatusCodes::get_failure_exit_status());
+}
+
 /**
  * A main function that runs the program
  * 
+ * Usage: main [options] [--jit] [--instances <images_file>] <program_file>
+ *        main [options] --batch <list_file | directory> [--workers-report]
+ *        main [options] --assemble <program_file> <bytecode_file>
+ *        main [options] --disassemble <program_file | bytecode_file>
+ *        main [options] [--jit] --prefix <program_file> <program_file>...
+ *
+ * Options: --flush <exit|threshold|line>, --output-format <text|binary|indexed>,
+ *          --output <file>, --loader <mmap|stream>, --load-report, --cache <directory>,
+ *          --memory-size <bytes>, --stack-size <bytes>
+ *
+ * Unknown flags, flags without their value and extra program files are rejected.
+ *
  * @param argc Number of command-line arguments
  * @param argv Array of command-line arguments
  * @returns int Status code
  */
 int main(const int argc, const char** argv) {
-    if (argc >= HardcodedValues::get_minimal_program_arguments_number()) {
-        const string program_file_path = argv[HardcodedValues::get_program_file_path_index()];
-        functools::exec(program_file_path);
-    } else {
+    string program_file_path;
+    string images_file_path;
+    string batch_path;
+    string output_path;
+    string bytecode_path;
+    string prefix_path;
+    vector<string> program_paths;
+    bool is_disassemble = false;
+    bool use_jit = false;
+    bool is_workers_report = false;
+    optional<FlushPolicy> flush_policy;
+    OutputFormat output_format = OUTPUT_TEXT;
+    LoadOptions load_options;
+
+    for (int i = HardcodedValues::get_program_file_path_index(); i < argc; ++i) {
+        const string_view argument = argv[i];
+
+        if (argument == CommandLineFlags::get_jit_flag())
+            use_jit = true;
+        else if (argument == CommandLineFlags::get_workers_report_flag())
+            is_workers_report = true;
+        else if (argument == CommandLineFlags::get_load_report_flag())
+            load_options.is_report = true;
+        else if (argument == CommandLineFlags::get_instances_flag())
+            images_file_path = get_flag_value(argc, argv, i);
+        else if (argument == CommandLineFlags::get_batch_flag())
+            batch_path = get_flag_value(argc, argv, i);
+        else if (argument == CommandLineFlags::get_flush_flag())
+            flush_policy = parse_flush_policy(get_flag_value(argc, argv, i));
+        else if (argument == CommandLineFlags::get_output_format_flag())
+            output_format = parse_output_format(get_flag_value(argc, argv, i));
+        else if (argument == CommandLineFlags::get_output_flag())
+            output_path = get_flag_value(argc, argv, i);
+        else if (argument == CommandLineFlags::get_assemble_flag()) {
+            if (i + 2 >= argc)
+                exit_with_argument_error(ErrorMessages::get_missing_flag_value_error(), argument);
+
+            program_file_path = argv[++i];
+            bytecode_path = argv[++i];
+        } else if (argument == CommandLineFlags::get_disassemble_flag()) {
+            program_file_path = get_flag_value(argc, argv, i);
+            is_disassemble = true;
+        } else if (argument == CommandLineFlags::get_cache_flag())
+            load_options.cache_directory = get_flag_value(argc, argv, i);
+        else if (argument == CommandLineFlags::get_prefix_flag())
+            prefix_path = get_flag_value(argc, argv, i);
+        else if (argument == CommandLineFlags::get_loader_flag())
+            load_options.loader = parse_loader(get_flag_value(argc, argv, i));
+        else if (argument == CommandLineFlags::get_memory_size_flag())
+            load_options.memory_size = parse_size(get_flag_value(argc, argv, i),
+                                                  Memory::is_valid_size,
+                                                  ErrorMessages::get_invalid_memory_size_error());
+        else if (argument == CommandLineFlags::get_stack_size_flag())
+            load_options.stack_size = parse_size(get_flag_value(argc, argv, i),
+                                                 Memory::is_valid_stack_size,
+                                                 ErrorMessages::get_invalid_stack_size_error());
+        else if (argument.starts_with(CommandLineFlags::get_flag_prefix()))
+            exit_with_argument_error(ErrorMessages::get_unknown_flag_error(), argument);
+        else
+            program_paths.push_back(argv[i]);
+    }
+
+    // The other modes run no continuations; --batch, --assemble and --disassemble take their
+    // program files as flag values
+    string_view mode_flag;
+
+    if (!batch_path.empty())
+        mode_flag = CommandLineFlags::get_batch_flag();
+    else if (!images_file_path.empty())
+        mode_flag = CommandLineFlags::get_instances_flag();
+    else if (!bytecode_path.empty())
+        mode_flag = CommandLineFlags::get_assemble_flag();
+    else if (is_disassemble)
+        mode_flag = CommandLineFlags::get_disassemble_flag();
+
+    if (!prefix_path.empty() && !mode_flag.empty())
+        exit_with_argument_error(ErrorMessages::get_prefix_mode_error(), mode_flag);
+
+    const bool is_program_in_flags = !batch_path.empty() || !bytecode_path.empty() || is_disassemble;
+    size_t max_program_paths = 1;
+
+    if (!prefix_path.empty())
+        max_program_paths = program_paths.size();
+    else if (is_program_in_flags)
+        max_program_paths = 0;
+
+    if (program_paths.size() > max_program_paths)
+        exit_with_argument_error(ErrorMessages::get_unexpected_argument_error(),
+                                 program_paths[max_program_paths]);
+
+    if (!program_paths.empty()) program_file_path = program_paths.front();
+
+    ofstream output_file;
+
+    if (!output_path.empty()) {
+        output_file.open(output_path, ios::binary);
+
+        if (!output_file) {
+            cerr << ErrorMessages::get_unable_to_open_file_error() << output_path << endl;
+            exit(ExitStatusCodes::get_failure_exit_status());
+        }
+    }
+
+    ostream& output = output_path.empty() ? cout : output_file;
+
+    if (!batch_path.empty()) {
+        functools::exec_batch(batch_path, output, output_format, is_workers_report, load_options);
+        return ExitStatusCodes::get_success_exit_status();
+    }
+
+    if (program_file_path.empty()) {
         cerr << ErrorMessages::get_file_not_provided_error() << endl;
         exit(ExitStatusCodes::get_failure_exit_status());
     }
 
+    if (!bytecode_path.empty())
+        functools::assemble(program_file_path, bytecode_path, load_options);
+    else if (is_disassemble)
+        functools::disassemble(program_file_path, output, load_options);
+    else if (!images_file_path.empty())
+        functools::exec_instances(program_file_path, images_file_path, output, load_options);
+    else {
+        // Line buffering only pays off on a terminal
+        Machine machine(output,
+                        flush_policy.value_or(output_path.empty() ? OutputBuffer::get_default_policy()
+                                                                  : FLUSH_ON_THRESHOLD),
+                        output_format, load_options.memory_size, load_options.stack_size);
+        if (prefix_path.empty())
+            functools::exec(machine, program_file_path, use_jit, load_options);
+        else
+            functools::exec_continuations(machine, prefix_path, program_paths, use_jit,
+                                          load_options);
+    }
+
     return ExitStatusCodes::get_success_exit_status();
 }
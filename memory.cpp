@@ -3,34 +3,69 @@
  *
  * This file provides the implementation for the simulated memory used by the processor.
  * The memory module is responsible for:
- *  - Emulating a fixed-size RAM using a statically allocated array.
+ *  - Emulating a RAM of up to 64 KiB in a single page-aligned mapping.
  *  - Reading and writing 16-bit values from/to specific memory addresses.
- *  - Managing a stack with push and pop operations, including boundary checks.
- *  - Validating memory accesses to ensure that operations do not interfere with the reserved stack
- * region.
+ *  - Mapping a separate stack region, used by push and pop with boundary checks.
+ *  - Validating memory accesses to ensure that they stay inside the memory.
+ *  - Writing images of the memory and the stack, and mapping them back copy-on-write.
  *
  * @date: May 4, 2025
  */
 
 #include "memory.hpp"
 
+#include <cerrno>
 #include <iostream>
+#include <new>
 #include <string>
 #include <string_view>
+#include <sys/mman.h>
+#include <unistd.h>
 
 #include "values.hpp"
 
 using namespace std;
 
-uint8_t Memory::stack_pointer = 0;
-
 /**
- * Constructor for the Memory class
+ * Constructor for the Memory class. The memory starts zeroed and the stack empty.
  * 
- * @param nbytes The size of the memory in bytes
+ * @param nbytes The size of the memory in bytes, for which is_valid_size is true
+ * @param stack_size The size of the stack in bytes, for which is_valid_stack_size is true
  */
-Memory::Memory(const uint8_t nbytes) {
-    MEM = new uint8_t[nbytes];
+Memory::Memory(const size_t nbytes, const size_t stack_size)
+    : size(nbytes), stack_capacity(stack_size / HardcodedValues::get_stack_pointer_size()) {
+    const size_t page_size = get_page_size();
+    memory_mapping_size = round_up_to_pages(nbytes);
+
+    void* const memory_mapping = mmap(nullptr, memory_mapping_size, PROT_READ | PROT_WRITE,
+                                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (memory_mapping == MAP_FAILED) throw bad_alloc();
+
+    MEM = static_cast<uint8_t*>(memory_mapping);
+
+    // A guard page on each side of the pages that hold the stack
+    stack_pages_size = round_up_to_pages(stack_size);
+    stack_mapping_size = stack_pages_size + 2 * page_size;
+
+    void* const mapping = mmap(nullptr, stack_mapping_size, PROT_NONE,
+                               MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+    if (mapping == MAP_FAILED) {
+        munmap(MEM, memory_mapping_size);
+        throw bad_alloc();
+    }
+
+    stack_mapping = static_cast<uint8_t*>(mapping);
+
+    if (mprotect(stack_mapping + page_size, stack_pages_size, PROT_READ | PROT_WRITE) != 0) {
+        munmap(stack_mapping, stack_mapping_size);
+        munmap(MEM, memory_mapping_size);
+        throw bad_alloc();
+    }
+
+    // The top of the stack touches the upper guard page
+    stack = reinterpret_cast<uint16_t*>(stack_mapping + page_size + stack_pages_size - stack_size);
 }
 
 /**
@@ -39,74 +74,245 @@ Memory::Memory(const uint8_t nbytes) {
  * @return void: Nothing
  */
 Memory::~Memory() {
-    delete[] MEM;
+    munmap(stack_mapping, stack_mapping_size);
+    munmap(MEM, memory_mapping_size);
 }
 
 /**
- * Overloaded operator to read/write 16-bit values from/to memory
+ * Reads a 16-bit value from memory, exiting if the address is out of range
  * 
  * @param address Memory address
  * @return uint16_t: The value at the specified address
  */
-uint16_t& Memory::operator[](const uint8_t address) {
-    validate_address(address, ErrorMessages::get_writing_to_stack_region_error());
+uint16_t Memory::read(const uint16_t address) const {
+    validate_address(address);
 
-    return *reinterpret_cast<uint16_t*>(MEM + address);
+    return load(address);
 }
 
 /**
- * Overloaded operator to read 16-bit values from memory
+ * Writes a 16-bit value to memory, exiting if the address is out of range
  * 
  * @param address Memory address
- * @return uint16_t: The value at the specified address
+ * @param value The value to write
+ * @return void: Nothing
  */
-uint16_t Memory::operator[](const uint8_t address) const {
-    validate_address(address, ErrorMessages::get_reading_from_stack_region_error());
+void Memory::write(const uint16_t address, const uint16_t value) {
+    validate_address(address);
 
-    return static_cast<uint16_t>((MEM[address + 1] << HardcodedValues::get_bits_in_byte()) |
-                                 MEM[address]);
+    store(address, value);
 }
 
 /**
- * Adds a value to the top of the stack
- * @param value The value to write
+ * Returns the memory buffer
+ * 
+ * @return uint8_t*: The first byte of memory
+ */
+uint8_t* Memory::data() {
+    return MEM;
+}
+
+/**
+ * Returns the memory size
+ * 
+ * @return size_t: The size of the memory in bytes
+ */
+size_t Memory::get_size() const {
+    return size;
+}
+
+/**
+ * Checks whether a machine can have a memory of the given size: room for one 16-bit value,
+ * and no more than 16-bit addresses reach
+ * 
+ * @param nbytes The size of the memory in bytes
+ * @return bool: true if the size is valid
+ */
+bool Memory::is_valid_size(const size_t nbytes) {
+    return nbytes >= sizeof(uint16_t) && nbytes <= HardcodedValues::get_max_memory_size();
+}
+
+/**
+ * Checks whether a machine can have a stack of the given size: a whole number of 16-bit
+ * values, at least one and at most HardcodedValues::get_max_stack_size() bytes
+ * 
+ * @param stack_size The size of the stack in bytes
+ * @return bool: true if the size is valid
+ */
+bool Memory::is_valid_stack_size(const size_t stack_size) {
+    const auto value_size = static_cast<size_t>(HardcodedValues::get_stack_pointer_size());
+
+    return stack_size >= value_size && stack_size % value_size == 0 &&
+           stack_size <= HardcodedValues::get_max_stack_size();
+}
+
+/**
+ * Tells whether both ends of the stack touch a guard page, so that push_unchecked and
+ * pop_unchecked fault instead of overflowing or underflowing
+ * 
+ * @return bool: true if the stack size is a whole number of pages
+ */
+bool Memory::is_stack_guarded() const {
+    return stack_capacity * HardcodedValues::get_stack_pointer_size() % get_page_size() == 0;
+}
+
+/**
+ * Returns where the next pushed value goes, for code that keeps the stack pointer itself
+ * 
+ * @return uint16_t*: The first free slot of the stack
+ */
+uint16_t* Memory::get_stack_top() {
+    return stack + stack_pointer;
+}
+
+/**
+ * Moves the stack pointer, for code that kept it itself
+ * 
+ * @param top The first free slot of the stack, as returned by get_stack_top and then moved
  * @return void: Nothing
  */
-void Memory::push(const uint16_t value) {
-    validate_stack_pointer(ErrorMessages::get_stack_overflow_error(),
-                           stack_pointer + HardcodedValues::get_stack_pointer_size() >
-                               HardcodedValues::get_stack_size());
+void Memory::set_stack_top(const uint16_t* const top) {
+    stack_pointer = static_cast<size_t>(top - stack);
+}
+
+/**
+ * Tells which stack fault an access to a faulting address is, if any
+ * 
+ * @param address The address whose access faulted
+ * @return string_view: The stack overflow error for the guard page above the stack, the stack
+ * underflow error for the one below a guarded stack, and nothing for any other address
+ */
+string_view Memory::get_stack_fault_error(const void* const address) const {
+    const size_t page_size = get_page_size();
+    const auto* const byte = static_cast<const uint8_t*>(address);
+    const uint8_t* const upper_guard = stack_mapping + stack_mapping_size - page_size;
+
+    if (byte >= upper_guard && byte < stack_mapping + stack_mapping_size)
+        return ErrorMessages::get_stack_overflow_error();
 
-    const uint16_t memory_size = static_cast<uint16_t>(HardcodedValues::get_memory_size()) - 1;
-    MEM[stack_pointer] = static_cast<uint8_t>(value & memory_size);
-    MEM[stack_pointer + 1] =
-        static_cast<uint8_t>((value >> HardcodedValues::get_bits_in_byte()) & memory_size);
-    stack_pointer += HardcodedValues::get_stack_pointer_size();
+    if (is_stack_guarded() && byte >= stack_mapping && byte < stack_mapping + page_size)
+        return ErrorMessages::get_stack_underflow_error();
+
+    return {};
+}
+
+/**
+ * Returns how many values are on the stack
+ * 
+ * @return size_t: The stack pointer, in values
+ */
+size_t Memory::get_stack_pointer() const {
+    return stack_pointer;
 }
 
 /**
- * Removes the value from the top of the stack and returns that value
- * @return uint16_t: The value at the top of the stack
+ * Returns the size of an image of the memory and the stack, as written by write_image
+ * 
+ * @return size_t: The image size, in bytes, a whole number of pages
+ */
+size_t Memory::get_image_size() const {
+    return memory_mapping_size + stack_pages_size;
+}
+
+/**
+ * Writes the memory and the values on the stack into a file of get_image_size() bytes, laid
+ * out as they are mapped: the memory pages first, then the stack pages. The rest of the file
+ * is left untouched, so a file fresh from ftruncate stays sparse.
+ * 
+ * @param descriptor The image file, open for writing
+ * @return bool: true if the whole image was written
+ */
+bool Memory::write_image(const int descriptor) const {
+    const uint8_t* const stack_pages = stack_mapping + get_page_size();
+    const auto* const stack_bytes = reinterpret_cast<const uint8_t*>(stack);
+    const size_t stack_offset =
+        memory_mapping_size + static_cast<size_t>(stack_bytes - stack_pages);
+
+    return write_all(descriptor, MEM, size, 0) &&
+           write_all(descriptor, stack_bytes, stack_pointer * sizeof(uint16_t), stack_offset);
+}
+
+/**
+ * Replaces the memory and the stack by copy-on-write mappings of an image file. Nothing is
+ * copied: the pages of the file are shared until the machine writes to them, and only then
+ * copied, so restoring an image costs the pages touched since the last restore.
+ * 
+ * @param descriptor The image file, written by write_image of a memory of the same sizes
+ * @param image_stack_pointer The stack pointer when the image was written
+ * @return bool: true if the image is mapped; if not, the memory must not be used anymore
+ */
+bool Memory::map_image(const int descriptor, const size_t image_stack_pointer) {
+    void* const memory_mapping = mmap(MEM, memory_mapping_size, PROT_READ | PROT_WRITE,
+                                      MAP_PRIVATE | MAP_FIXED, descriptor, 0);
+
+    if (memory_mapping == MAP_FAILED) return false;
+
+    void* const stack_pages = mmap(stack_mapping + get_page_size(), stack_pages_size,
+                                   PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED | MAP_NORESERVE,
+                                   descriptor, static_cast<off_t>(memory_mapping_size));
+
+    if (stack_pages == MAP_FAILED) return false;
+
+    stack_pointer = image_stack_pointer;
+    return true;
+}
+
+/**
+ * Writes a whole buffer at an offset of a file, resuming writes that stop short
+ * 
+ * @param descriptor The file, open for writing
+ * @param bytes The buffer
+ * @param count The number of bytes to write
+ * @param offset Where to write them in the file
+ * @return bool: true if every byte was written
+ */
+bool Memory::write_all(const int descriptor, const uint8_t* bytes, size_t count, size_t offset) {
+    while (count > 0) {
+        const ssize_t written = pwrite(descriptor, bytes, count, static_cast<off_t>(offset));
+
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+
+        bytes += written;
+        count -= static_cast<size_t>(written);
+        offset += static_cast<size_t>(written);
+    }
+
+    return true;
+}
+
+/**
+ * Rounds a size up to a whole number of pages
+ * 
+ * @param nbytes The size, in bytes
+ * @return size_t: The smallest multiple of the page size that is at least nbytes
+ */
+size_t Memory::round_up_to_pages(const size_t nbytes) {
+    const size_t page_size = get_page_size();
+
+    return (nbytes + page_size - 1) / page_size * page_size;
+}
+
+/**
+ * Returns the size of a memory page, which guard pages are
+ * 
+ * @return size_t: The page size, in bytes
  */
-uint16_t Memory::pop()const {
-    validate_stack_pointer(ErrorMessages::get_stack_underflow_error(),
-                           stack_pointer < HardcodedValues::get_stack_pointer_size());
+size_t Memory::get_page_size() {
+    static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
 
-    stack_pointer -= HardcodedValues::get_stack_pointer_size();
-    return static_cast<uint16_t>((MEM[stack_pointer + 1] << HardcodedValues::get_bits_in_byte()) |
-                                 MEM[stack_pointer]);
+    return page_size;
 }
 
 /**
- * Validates if we are reading/writing from/to the heap
+ * Validates that the whole 16-bit value at an address is inside the memory
  * 
  * @param address Memory address
- * @param error_message Error message to print
  * @return void: Nothing
  */
-void Memory::validate_address(const uint8_t& address, const string_view& error_message) {
-    if (address < HardcodedValues::get_stack_size()) {
-        cerr << error_message << address << endl;
+void Memory::validate_address(const uint16_t& address) const {
+    if (address + sizeof(uint16_t) > size) {
+        cerr << ErrorMessages::get_address_out_of_range_error() << address << endl;
         exit(ExitStatusCodes::get_failure_exit_status());
     }
 }
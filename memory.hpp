@@ -8,15 +8,38 @@
  *  - Push a 16-bit value onto a simulated stack.
  *  - Pop a 16-bit value from the simulated stack.
  *
+ * The memory size is chosen per machine, up to 64 KiB, all of it reachable by 16-bit
+ * addresses. The memory is one zeroed, page-aligned mapping of its own.
+ * 16-bit values are stored little-endian at any address. Every access goes through load and
+ * store, which copy the value with memcpy: on little-endian hosts each one compiles to a
+ * single 16-bit mov, and they are defined here so that they are inlined.
+ *
+ * The stack is a region of its own, outside the addressable memory, whose size is also chosen
+ * per machine. It is mapped without reserving swap, so only the pages a program actually
+ * pushes to are ever backed by memory. Push and pop check it with a single compare.
+ *
+ * The stack ends right below a PROT_NONE guard page, so a push past its top faults. When its
+ * size is a whole number of pages it also starts right above one, a pop from an empty stack
+ * faults too, and the stack is guarded: push_unchecked and pop_unchecked may be used under a
+ * StackGuard, which turns those faults into stack overflow and underflow errors.
+ *
+ * The memory and the stack can be written to an image file and mapped back from it
+ * copy-on-write, which is how machine snapshots are restored without copying them.
+ *
  * @date: May 4, 2025
  */
 
 #ifndef MEMORY_HPP
 #define MEMORY_HPP
 
+#include <bit>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <string_view>
 
+#include "values.hpp"
+
 using namespace std;
 
 /**
@@ -26,23 +49,147 @@ using namespace std;
  */
 class Memory {
     uint8_t* MEM;
-    static uint8_t stack_pointer;
+    size_t size;
+    size_t memory_mapping_size;
+    uint16_t* stack;
+    size_t stack_capacity;
+    size_t stack_pointer = 0;
+    uint8_t* stack_mapping;
+    size_t stack_mapping_size;
+    size_t stack_pages_size;
 
     // Validation methods
-    static void validate_address(const uint8_t& address, const string_view& error_message);
+    void validate_address(const uint16_t& address) const;
     static void validate_stack_pointer(const string_view& error_message, const bool& is_error);
+    static size_t get_page_size();
+    static size_t round_up_to_pages(size_t nbytes);
+    static bool write_all(int descriptor, const uint8_t* bytes, size_t count, size_t offset);
 
    public:
-    Memory(uint8_t nbytes);
+    explicit Memory(size_t nbytes, size_t stack_size = HardcodedValues::get_stack_size());
+    Memory(const Memory&) = delete;
+    Memory& operator=(const Memory&) = delete;
     ~Memory();
 
-    // Heap operators
-    uint16_t& operator[](uint8_t address);
-    uint16_t operator[](uint8_t address) const;
+    // Heap access with validation
+    uint16_t read(uint16_t address) const;
+    void write(uint16_t address, uint16_t value);
+
+    // Heap access without validation, for addresses checked by functools::verify
+    uint16_t load(uint16_t address) const;
+    void store(uint16_t address, uint16_t value);
+
+    // Raw buffer, for code that addresses memory directly
+    uint8_t* data();
+    size_t get_size() const;
+
+    static bool is_valid_size(size_t nbytes);
+    static bool is_valid_stack_size(size_t stack_size);
 
     // Stack operations
+    bool can_push() const;
+    bool can_pop() const;
     void push(uint16_t value);
-    uint16_t pop()const;
+    uint16_t pop();
+
+    // Stack operations without bounds checks, for guarded stacks
+    bool is_stack_guarded() const;
+    void push_unchecked(uint16_t value);
+    uint16_t pop_unchecked();
+    uint16_t* get_stack_top();
+    void set_stack_top(const uint16_t* top);
+    string_view get_stack_fault_error(const void* address) const;
+
+    // Copy-on-write images of the memory and the stack, for snapshots
+    size_t get_stack_pointer() const;
+    size_t get_image_size() const;
+    bool write_image(int descriptor) const;
+    bool map_image(int descriptor, size_t image_stack_pointer);
 };
 
+/**
+ * Reads the little-endian 16-bit value at an address, without any validation
+ * 
+ * @param address Memory address; address + 1 must be inside the memory
+ * @return uint16_t: The value at the specified address
+ */
+inline uint16_t Memory::load(const uint16_t address) const {
+    uint16_t value;
+    memcpy(&value, MEM + address, sizeof(value));
+
+    if constexpr (endian::native == endian::big) value = byteswap(value);
+
+    return value;
+}
+
+/**
+ * Writes a 16-bit value at an address, little-endian, without any validation
+ * 
+ * @param address Memory address; address + 1 must be inside the memory
+ * @param value The value to write
+ * @return void: Nothing
+ */
+inline void Memory::store(const uint16_t address, uint16_t value) {
+    if constexpr (endian::native == endian::big) value = byteswap(value);
+
+    memcpy(MEM + address, &value, sizeof(value));
+}
+
+/**
+ * Checks whether there is room on the stack for one more value
+ * @return bool: true if push would succeed
+ */
+inline bool Memory::can_push() const {
+    return stack_pointer != stack_capacity;
+}
+
+/**
+ * Checks whether there is a value on the stack
+ * @return bool: true if pop would succeed
+ */
+inline bool Memory::can_pop() const {
+    return stack_pointer != 0;
+}
+
+/**
+ * Adds a value to the top of the stack
+ * @param value The value to write
+ * @return void: Nothing
+ */
+inline void Memory::push(const uint16_t value) {
+    validate_stack_pointer(ErrorMessages::get_stack_overflow_error(), !can_push());
+
+    stack[stack_pointer++] = value;
+}
+
+/**
+ * Removes the value from the top of the stack and returns that value
+ * @return uint16_t: The value at the top of the stack
+ */
+inline uint16_t Memory::pop() {
+    validate_stack_pointer(ErrorMessages::get_stack_underflow_error(), !can_pop());
+
+    return stack[--stack_pointer];
+}
+
+/**
+ * Adds a value to the top of a guarded stack, faulting on the guard page if it is full
+ * @param value The value to write
+ * @return void: Nothing
+ */
+inline void Memory::push_unchecked(const uint16_t value) {
+    stack[stack_pointer] = value;
+    ++stack_pointer;
+}
+
+/**
+ * Removes the value from the top of a guarded stack, faulting on the guard page if it is empty
+ * @return uint16_t: The value at the top of the stack
+ */
+inline uint16_t Memory::pop_unchecked() {
+    const uint16_t value = stack[stack_pointer - 1];
+    --stack_pointer;
+    return value;
+}
+
 #endif
\ No newline at end of file
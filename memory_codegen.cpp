@@ -0,0 +1,24 @@
+/**
+ * @file memory_codegen.cpp
+ *
+ * This file is only compiled to assembly, by test_memory_codegen.sh: it wraps Memory::load
+ * and Memory::store in functions with unmangled names, so that the script can check that
+ * each of them compiles to a single 16-bit move.
+ *
+ * @date May 4, 2025
+ */
+
+#include <cstdint>
+
+#include "memory.hpp"
+
+using namespace std;
+
+extern "C" uint16_t memory_codegen_load(const Memory& memory, const uint16_t address) {
+    return memory.load(address);
+}
+
+extern "C" void memory_codegen_store(Memory& memory, const uint16_t address,
+                                     const uint16_t value) {
+    memory.store(address, value);
+}
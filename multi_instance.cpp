@@ -0,0 +1,506 @@
+/**
+ * @file multi_instance.cpp
+ *
+ * This file implements the multi-instance engine. The engine walks the program once and,
+ * for every instruction, calls one kernel that updates all lanes:
+ *  - SET/ADD/SUB: a masked move, saturating add or saturating subtract of a register row
+ *    (e.g. _mm256_adds_epu16 / _mm256_subs_epu16, which are exactly the Register semantics).
+ *  - IFNZ: a compare against zero that produces the skip mask of the next instruction.
+ *  - LOAD/STORE: the two byte rows of the address are widened into, or narrowed from, a
+ *    row of 16-bit values.
+ * PRINT, PUSH and POP touch per-instance state (output and stack pointer) and are done lane
+ * by lane. An instance whose stack overflows or underflows is halted and stays masked out.
+ * The lane stacks are mapped without reserving memory, so only the slots in use take any.
+ *
+ * Lane counts are padded to a multiple of the widest vector, so kernels never handle tails.
+ *
+ * @date May 4, 2025
+ */
+
+#include "multi_instance.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <sys/mman.h>
+
+#include "hardware.hpp"
+#include "values.hpp"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+constexpr size_t LANES_ALIGNMENT = 32;  // AVX-512BW lanes of 16 bits
+constexpr uint16_t LANE_SKIPPED = UINT16_MAX;
+
+/**
+ * @enum LaneOperation
+ *
+ * The register-writing operations an arithmetic kernel can perform
+ */
+enum LaneOperation {
+    LANE_SET,
+    LANE_ADD,
+    LANE_SUB,
+};
+
+constexpr size_t LANE_OPERATIONS_NUMBER = LANE_SUB + 1;
+
+using ArithmeticKernel = void (*)(uint16_t* destination, const uint16_t* source,
+                                  uint16_t immediate, const uint16_t* skip, size_t lanes);
+using TestZeroKernel = void (*)(uint16_t* next_skip, const uint16_t* value, const uint16_t* skip,
+                                size_t lanes);
+using LoadKernel = void (*)(uint16_t* destination, const uint8_t* low, const uint8_t* high,
+                            const uint16_t* skip, size_t lanes);
+using StoreKernel = void (*)(uint8_t* low, uint8_t* high, const uint16_t* source,
+                             const uint16_t* skip, size_t lanes);
+
+/**
+ * @struct LaneKernels
+ *
+ * One implementation of every kernel, for one instruction set
+ */
+struct LaneKernels {
+    string_view instruction_set;
+    ArithmeticKernel arithmetic[LANE_OPERATIONS_NUMBER][2];  // [operation][NUMERIC/REGISTER]
+    TestZeroKernel test_zero;
+    LoadKernel load;
+    StoreKernel store;
+};
+
+/**
+ * Scalar kernels, for processors without AVX2
+ */
+template <LaneOperation operation, OperandType type>
+void arithmetic_scalar(uint16_t* destination, const uint16_t* source, const uint16_t immediate,
+                       const uint16_t* skip, const size_t lanes) {
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        if (skip[lane]) continue;
+
+        const uint32_t current = destination[lane];
+        uint32_t operand = immediate;
+
+        if constexpr (type == REGISTER) operand = source[lane];
+
+        if constexpr (operation == LANE_SET)
+            destination[lane] = static_cast<uint16_t>(operand);
+        else if constexpr (operation == LANE_ADD)
+            destination[lane] = static_cast<uint16_t>(min<uint32_t>(current + operand, UINT16_MAX));
+        else
+            destination[lane] = static_cast<uint16_t>(current > operand ? current - operand : 0);
+    }
+}
+
+void test_zero_scalar(uint16_t* next_skip, const uint16_t* value, const uint16_t* skip,
+                      const size_t lanes) {
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        next_skip[lane] = !skip[lane] && value[lane] == 0 ? LANE_SKIPPED : 0;
+    }
+}
+
+void load_scalar(uint16_t* destination, const uint8_t* low, const uint8_t* high,
+                 const uint16_t* skip, const size_t lanes) {
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        if (!skip[lane]) destination[lane] = static_cast<uint16_t>(low[lane] | high[lane] << 8);
+    }
+}
+
+void store_scalar(uint8_t* low, uint8_t* high, const uint16_t* source, const uint16_t* skip,
+                  const size_t lanes) {
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        if (skip[lane]) continue;
+
+        low[lane] = static_cast<uint8_t>(source[lane]);
+        high[lane] = static_cast<uint8_t>(source[lane] >> 8);
+    }
+}
+
+constexpr LaneKernels SCALAR_KERNELS = {
+    "scalar",
+    {{&arithmetic_scalar<LANE_SET, NUMERIC>, &arithmetic_scalar<LANE_SET, REGISTER>},
+     {&arithmetic_scalar<LANE_ADD, NUMERIC>, &arithmetic_scalar<LANE_ADD, REGISTER>},
+     {&arithmetic_scalar<LANE_SUB, NUMERIC>, &arithmetic_scalar<LANE_SUB, REGISTER>}},
+    &test_zero_scalar,
+    &load_scalar,
+    &store_scalar,
+};
+
+#if defined(__x86_64__)
+
+/**
+ * AVX2 kernels: 16 lanes per operation. Skip masks are all-ones words, so they select
+ * between the old and the new row with a byte blend.
+ */
+template <LaneOperation operation, OperandType type>
+__attribute__((target("avx2"))) void arithmetic_avx2(uint16_t* destination, const uint16_t* source,
+                                                     const uint16_t immediate, const uint16_t* skip,
+                                                     const size_t lanes) {
+    const __m256i broadcast = _mm256_set1_epi16(static_cast<short>(immediate));
+
+    for (size_t lane = 0; lane < lanes; lane += 16) {
+        auto* row = reinterpret_cast<__m256i*>(destination + lane);
+        const __m256i current = _mm256_loadu_si256(row);
+        __m256i operand = broadcast;
+        __m256i result;
+
+        if constexpr (type == REGISTER)
+            operand = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + lane));
+
+        if constexpr (operation == LANE_SET)
+            result = operand;
+        else if constexpr (operation == LANE_ADD)
+            result = _mm256_adds_epu16(current, operand);
+        else
+            result = _mm256_subs_epu16(current, operand);
+
+        const __m256i mask = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(skip + lane));
+        _mm256_storeu_si256(row, _mm256_blendv_epi8(result, current, mask));
+    }
+}
+
+__attribute__((target("avx2"))) void test_zero_avx2(uint16_t* next_skip, const uint16_t* value,
+                                                    const uint16_t* skip, const size_t lanes) {
+    for (size_t lane = 0; lane < lanes; lane += 16) {
+        const __m256i row = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(value + lane));
+        const __m256i mask = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(skip + lane));
+        const __m256i is_zero = _mm256_cmpeq_epi16(row, _mm256_setzero_si256());
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(next_skip + lane),
+                            _mm256_andnot_si256(mask, is_zero));
+    }
+}
+
+__attribute__((target("avx2"))) void load_avx2(uint16_t* destination, const uint8_t* low,
+                                               const uint8_t* high, const uint16_t* skip,
+                                               const size_t lanes) {
+    for (size_t lane = 0; lane < lanes; lane += 16) {
+        auto* row = reinterpret_cast<__m256i*>(destination + lane);
+        const __m256i low_bytes =
+            _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(low + lane)));
+        const __m256i high_bytes =
+            _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(high + lane)));
+        const __m256i result = _mm256_or_si256(low_bytes, _mm256_slli_epi16(high_bytes, 8));
+        const __m256i mask = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(skip + lane));
+        _mm256_storeu_si256(row, _mm256_blendv_epi8(result, _mm256_loadu_si256(row), mask));
+    }
+}
+
+/**
+ * Narrows 16 words into 16 bytes, keeping the low byte of each word
+ */
+__attribute__((target("avx2"))) __m128i narrow_avx2(const __m256i words) {
+    const __m256i packed = _mm256_packus_epi16(_mm256_and_si256(words, _mm256_set1_epi16(0xFF)),
+                                               _mm256_setzero_si256());
+    return _mm256_castsi256_si128(_mm256_permute4x64_epi64(packed, 0b1000));
+}
+
+__attribute__((target("avx2"))) void store_avx2(uint8_t* low, uint8_t* high, const uint16_t* source,
+                                                const uint16_t* skip, const size_t lanes) {
+    for (size_t lane = 0; lane < lanes; lane += 16) {
+        const __m256i row = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + lane));
+        const __m128i mask =
+            narrow_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(skip + lane)));
+        auto* low_row = reinterpret_cast<__m128i*>(low + lane);
+        auto* high_row = reinterpret_cast<__m128i*>(high + lane);
+
+        _mm_storeu_si128(low_row,
+                         _mm_blendv_epi8(narrow_avx2(row), _mm_loadu_si128(low_row), mask));
+        _mm_storeu_si128(high_row, _mm_blendv_epi8(narrow_avx2(_mm256_srli_epi16(row, 8)),
+                                                   _mm_loadu_si128(high_row), mask));
+    }
+}
+
+constexpr LaneKernels AVX2_KERNELS = {
+    "avx2",
+    {{&arithmetic_avx2<LANE_SET, NUMERIC>, &arithmetic_avx2<LANE_SET, REGISTER>},
+     {&arithmetic_avx2<LANE_ADD, NUMERIC>, &arithmetic_avx2<LANE_ADD, REGISTER>},
+     {&arithmetic_avx2<LANE_SUB, NUMERIC>, &arithmetic_avx2<LANE_SUB, REGISTER>}},
+    &test_zero_avx2,
+    &load_avx2,
+    &store_avx2,
+};
+
+/**
+ * AVX-512BW kernels: 32 lanes per operation, with skip masks turned into mask registers
+ */
+template <LaneOperation operation, OperandType type>
+__attribute__((target("avx512bw,avx512vl"))) void arithmetic_avx512(
+    uint16_t* destination, const uint16_t* source, const uint16_t immediate, const uint16_t* skip,
+    const size_t lanes) {
+    const __m512i broadcast = _mm512_set1_epi16(static_cast<short>(immediate));
+
+    for (size_t lane = 0; lane < lanes; lane += 32) {
+        const __m512i current = _mm512_loadu_si512(destination + lane);
+        __m512i operand = broadcast;
+        __m512i result;
+
+        if constexpr (type == REGISTER) operand = _mm512_loadu_si512(source + lane);
+
+        if constexpr (operation == LANE_SET)
+            result = operand;
+        else if constexpr (operation == LANE_ADD)
+            result = _mm512_adds_epu16(current, operand);
+        else
+            result = _mm512_subs_epu16(current, operand);
+
+        const __mmask32 active = ~_mm512_movepi16_mask(_mm512_loadu_si512(skip + lane));
+        _mm512_mask_storeu_epi16(destination + lane, active, result);
+    }
+}
+
+__attribute__((target("avx512bw,avx512vl"))) void test_zero_avx512(uint16_t* next_skip,
+                                                                   const uint16_t* value,
+                                                                   const uint16_t* skip,
+                                                                   const size_t lanes) {
+    for (size_t lane = 0; lane < lanes; lane += 32) {
+        const __mmask32 active = ~_mm512_movepi16_mask(_mm512_loadu_si512(skip + lane));
+        const __mmask32 is_zero =
+            _mm512_mask_cmpeq_epi16_mask(active, _mm512_loadu_si512(value + lane), _mm512_setzero_si512());
+        _mm512_storeu_si512(next_skip + lane, _mm512_movm_epi16(is_zero));
+    }
+}
+
+__attribute__((target("avx512bw,avx512vl"))) void load_avx512(uint16_t* destination,
+                                                              const uint8_t* low,
+                                                              const uint8_t* high,
+                                                              const uint16_t* skip,
+                                                              const size_t lanes) {
+    for (size_t lane = 0; lane < lanes; lane += 32) {
+        const __m512i low_bytes =
+            _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(low + lane)));
+        const __m512i high_bytes =
+            _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(high + lane)));
+        const __mmask32 active = ~_mm512_movepi16_mask(_mm512_loadu_si512(skip + lane));
+        _mm512_mask_storeu_epi16(destination + lane, active,
+                                 _mm512_or_si512(low_bytes, _mm512_slli_epi16(high_bytes, 8)));
+    }
+}
+
+__attribute__((target("avx512bw,avx512vl"))) void store_avx512(uint8_t* low, uint8_t* high,
+                                                               const uint16_t* source,
+                                                               const uint16_t* skip,
+                                                               const size_t lanes) {
+    for (size_t lane = 0; lane < lanes; lane += 32) {
+        const __m512i row = _mm512_loadu_si512(source + lane);
+        const __mmask32 active = ~_mm512_movepi16_mask(_mm512_loadu_si512(skip + lane));
+        _mm256_mask_storeu_epi8(low + lane, active, _mm512_cvtepi16_epi8(row));
+        _mm256_mask_storeu_epi8(high + lane, active, _mm512_cvtepi16_epi8(_mm512_srli_epi16(row, 8)));
+    }
+}
+
+constexpr LaneKernels AVX512_KERNELS = {
+    "avx512bw",
+    {{&arithmetic_avx512<LANE_SET, NUMERIC>, &arithmetic_avx512<LANE_SET, REGISTER>},
+     {&arithmetic_avx512<LANE_ADD, NUMERIC>, &arithmetic_avx512<LANE_ADD, REGISTER>},
+     {&arithmetic_avx512<LANE_SUB, NUMERIC>, &arithmetic_avx512<LANE_SUB, REGISTER>}},
+    &test_zero_avx512,
+    &load_avx512,
+    &store_avx512,
+};
+
+#endif
+
+/**
+ * Picks the kernels of the widest instruction set the processor supports
+ *
+ * @return const LaneKernels& The kernels
+ */
+const LaneKernels& select_kernels() {
+#if defined(__x86_64__)
+    if (__builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vl"))
+        return AVX512_KERNELS;
+    if (__builtin_cpu_supports("avx2")) return AVX2_KERNELS;
+#endif
+
+    return SCALAR_KERNELS;
+}
+
+/**
+ * Returns the name of the instruction set the kernels will use
+ *
+ * @return string_view "avx512bw", "avx2" or "scalar"
+ */
+string_view MultiInstanceEngine::get_instruction_set() {
+    return select_kernels().instruction_set;
+}
+
+/**
+ * @class LaneStacks
+ *
+ * The stacks of all lanes, one row of lanes per stack slot, in an anonymous mapping that
+ * reserves no memory up front. Only the rows that some instance pushes to are ever backed by
+ * pages, so a deep stack costs what the instances actually use, not its size times the lanes.
+ */
+class LaneStacks {
+    uint16_t* slots;
+    size_t mapping_size;
+    size_t lanes;
+
+   public:
+    LaneStacks(const size_t capacity, const size_t lanes)
+        : mapping_size(capacity * lanes * sizeof(uint16_t)), lanes(lanes) {
+        void* const mapping = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE,
+                                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+        if (mapping == MAP_FAILED) throw bad_alloc();
+
+        slots = static_cast<uint16_t*>(mapping);
+    }
+
+    LaneStacks(const LaneStacks&) = delete;
+    LaneStacks& operator=(const LaneStacks&) = delete;
+
+    ~LaneStacks() { munmap(slots, mapping_size); }
+
+    uint16_t* row(const size_t slot) const { return slots + slot * lanes; }
+};
+
+/**
+ * Maps an opcode to the operation of its arithmetic kernel
+ *
+ * @param opcode A SET, ADD or SUB opcode
+ * @return LaneOperation The operation
+ */
+LaneOperation get_lane_operation(const Opcode opcode) {
+    if (opcode == SETv || opcode == SETr) return LANE_SET;
+    if (opcode == ADDv || opcode == ADDr) return LANE_ADD;
+
+    return LANE_SUB;
+}
+
+/**
+ * Runs a program verified for memory_size bytes once per memory image. Every image must be
+ * memory_size bytes long; registers and stack start empty.
+ *
+ * @param program The program to run
+ * @param images The initial memory of every instance
+ * @param memory_size The memory size of every instance
+ * @param stack_size The stack size of every instance, in bytes
+ * @return vector<InstanceResult> What each instance printed, and why it stopped if it failed
+ */
+vector<InstanceResult> MultiInstanceEngine::run(const Program& program,
+                                                span<const vector<uint8_t>> images,
+                                                const size_t memory_size,
+                                                const size_t stack_size) {
+    const LaneKernels& kernels = select_kernels();
+    const size_t instances = images.size();
+    const size_t lanes = (instances + LANES_ALIGNMENT - 1) / LANES_ALIGNMENT * LANES_ALIGNMENT;
+    const size_t stack_capacity = stack_size / HardcodedValues::get_stack_pointer_size();
+
+    vector<InstanceResult> results(instances);
+    vector<uint16_t> registers(RegistersManager::REGISTERS_NUMBER * lanes, 0);
+    vector<uint8_t> memory(memory_size * lanes, 0);
+    const LaneStacks stack(stack_capacity, lanes);
+    vector<size_t> stack_pointers(lanes, 0);
+    vector<uint16_t> halted(lanes, 0);
+    vector<uint16_t> skip(lanes, 0);
+    vector<uint16_t> next_skip(lanes, 0);
+    bool is_skip_halted = true;  // whether skip is a copy of halted
+
+    // Padding lanes do not belong to any instance and never run
+    fill(halted.begin() + static_cast<ptrdiff_t>(instances), halted.end(), LANE_SKIPPED);
+    skip = halted;
+
+    for (size_t instance = 0; instance < instances; ++instance) {
+        for (size_t address = 0; address < memory_size; ++address) {
+            memory[address * lanes + instance] = images[instance][address];
+        }
+    }
+
+    const auto register_row = [&](const uint16_t id) { return registers.data() + id * lanes; };
+    const auto memory_row = [&](const size_t address) { return memory.data() + address * lanes; };
+    const auto stack_row = [&](const size_t slot) { return stack.row(slot); };
+    size_t program_counter = 0;
+
+    const auto halt = [&](const size_t lane, const string_view error) {
+        results[lane].error = error;
+        results[lane].error_line = program.get_line(program_counter);
+        halted[lane] = LANE_SKIPPED;
+        skip[lane] = LANE_SKIPPED;
+    };
+
+    for (; program_counter < program.instructions.size(); ++program_counter) {
+        const Instruction& instruction = program.instructions[program_counter];
+        const uint16_t first = instruction.values[0];
+        const uint16_t second = instruction.values[1];
+
+        switch (instruction.opcode) {
+            case SETv:
+            case SETr:
+            case ADDv:
+            case ADDr:
+            case SUBv:
+            case SUBr:
+                kernels.arithmetic[get_lane_operation(instruction.opcode)][instruction.types[1] == REGISTER](
+                    register_row(first),
+                    instruction.types[1] == REGISTER ? register_row(second) : nullptr, second,
+                    skip.data(), lanes);
+                break;
+
+            case IFNZ:
+                kernels.test_zero(next_skip.data(), register_row(first), skip.data(), lanes);
+
+                for (size_t lane = 0; lane < lanes; ++lane) next_skip[lane] |= halted[lane];
+
+                swap(skip, next_skip);
+                is_skip_halted = false;
+                continue;
+
+            case LOAD:
+                kernels.load(register_row(second), memory_row(first), memory_row(first + 1),
+                             skip.data(), lanes);
+                break;
+
+            case STORE:
+                kernels.store(memory_row(first), memory_row(first + 1), register_row(second),
+                              skip.data(), lanes);
+                break;
+
+            case PRINT:
+                for (size_t lane = 0; lane < instances; ++lane) {
+                    if (!skip[lane]) results[lane].printed.push_back(register_row(first)[lane]);
+                }
+                break;
+
+            case PUSH:
+                for (size_t lane = 0; lane < instances; ++lane) {
+                    if (skip[lane]) continue;
+
+                    size_t& stack_pointer = stack_pointers[lane];
+
+                    if (stack_pointer == stack_capacity) {
+                        halt(lane, ErrorMessages::get_stack_overflow_error());
+                        continue;
+                    }
+
+                    stack_row(stack_pointer++)[lane] = register_row(first)[lane];
+                }
+                break;
+
+            case POP:
+                for (size_t lane = 0; lane < instances; ++lane) {
+                    if (skip[lane]) continue;
+
+                    size_t& stack_pointer = stack_pointers[lane];
+
+                    if (stack_pointer == 0) {
+                        halt(lane, ErrorMessages::get_stack_underflow_error());
+                        continue;
+                    }
+
+                    register_row(first)[lane] = stack_row(--stack_pointer)[lane];
+                }
+                break;
+        }
+
+        // Only the instruction right after IFNZ is skipped
+        if (!is_skip_halted) {
+            skip = halted;
+            is_skip_halted = true;
+        }
+    }
+
+    return results;
+}
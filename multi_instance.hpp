@@ -0,0 +1,51 @@
+/**
+ * @file multi_instance.hpp
+ *
+ * This file declares the multi-instance engine, which runs one program over many initial
+ * memory images at once. Every instance is a lane: registers and memory are stored as
+ * structure-of-arrays, one row of lanes per register and per memory byte, and every decoded
+ * instruction is executed across all lanes by a vector kernel (AVX-512BW: 32 lanes per
+ * operation, AVX2: 16, with a scalar fallback). IFNZ does not branch: lanes whose register is
+ * zero are masked out of the next instruction instead.
+ *
+ * @date May 4, 2025
+ */
+
+#ifndef MULTI_INSTANCE_HPP
+#define MULTI_INSTANCE_HPP
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "instructions.hpp"
+
+using namespace std;
+
+/**
+ * @struct InstanceResult
+ *
+ * What one instance produced: the values it printed, in order, and the error that stopped
+ * it, if any, with the source line it stopped at.
+ */
+struct InstanceResult {
+    vector<uint16_t> printed;
+    string_view error;
+    size_t error_line = 0;
+};
+
+/**
+ * @class MultiInstanceEngine
+ *
+ * Runs a verified program over a batch of memory images with the widest vector kernels the
+ * processor supports.
+ */
+class MultiInstanceEngine {
+   public:
+    static string_view get_instruction_set();
+    static vector<InstanceResult> run(const Program& program, span<const vector<uint8_t>> images,
+                                      size_t memory_size, size_t stack_size);
+};
+
+#endif
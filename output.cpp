@@ -0,0 +1,89 @@
+/**
+ * @file output.cpp
+ *
+ * This file implements the output buffer PRINT writes to.
+ *
+ * @date May 4, 2025
+ */
+
+#include "output.hpp"
+
+#include <limits>
+#include <unistd.h>
+
+#include "values.hpp"
+
+using namespace std;
+
+/**
+ * Constructor for the OutputBuffer class
+ *
+ * @param stream The stream printed values are written to
+ * @param policy When pending output is written to the stream
+ * @param format How printed values are written
+ */
+OutputBuffer::OutputBuffer(ostream& stream, const FlushPolicy policy, const OutputFormat format)
+    : stream(stream), threshold(HardcodedValues::get_output_buffer_size()), format(format) {
+    if (policy == FLUSH_ON_EXIT) threshold = numeric_limits<size_t>::max();
+    if (policy == FLUSH_ON_LINE) threshold = 0;
+
+    buffer.reserve(HardcodedValues::get_output_buffer_size());
+}
+
+/**
+ * Destructor for the OutputBuffer class. Writes whatever is still pending.
+ */
+OutputBuffer::~OutputBuffer() {
+    flush();
+}
+
+/**
+ * Writes the pending output to the stream in one write and flushes the stream
+ *
+ * @return void: Nothing
+ */
+void OutputBuffer::flush() {
+    if (buffer.empty()) return;
+
+    stream.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+    stream.flush();
+    buffer.clear();
+}
+
+/**
+ * Picks the policy used when none is given: line-buffered when stdout is a terminal, so that
+ * values show up as they are printed, and by threshold otherwise
+ *
+ * @return FlushPolicy: The default policy
+ */
+FlushPolicy OutputBuffer::get_default_policy() {
+    return isatty(STDOUT_FILENO) ? FLUSH_ON_LINE : FLUSH_ON_THRESHOLD;
+}
+
+/**
+ * Looks up a flush policy by its name
+ *
+ * @param name The policy name: exit, threshold or line
+ * @return optional<FlushPolicy>: The policy, or nullopt if the name is unknown
+ */
+optional<FlushPolicy> OutputBuffer::find_policy(const string_view name) {
+    for (size_t policy = 0; policy < FLUSH_POLICIES_NAMES.size(); ++policy) {
+        if (FLUSH_POLICIES_NAMES[policy] == name) return static_cast<FlushPolicy>(policy);
+    }
+
+    return nullopt;
+}
+
+/**
+ * Looks up an output format by its name
+ *
+ * @param name The format name: text, binary or indexed
+ * @return optional<OutputFormat>: The format, or nullopt if the name is unknown
+ */
+optional<OutputFormat> OutputBuffer::find_format(const string_view name) {
+    for (size_t format = 0; format < OUTPUT_FORMATS_NAMES.size(); ++format) {
+        if (OUTPUT_FORMATS_NAMES[format] == name) return static_cast<OutputFormat>(format);
+    }
+
+    return nullopt;
+}
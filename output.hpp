@@ -0,0 +1,117 @@
+/**
+ * @file output.hpp
+ *
+ * This file declares the output buffer PRINT writes to. Values are formatted with to_chars,
+ * or encoded as binary records, straight into a per-machine buffer, which is handed to the
+ * underlying stream according to a flush policy instead of flushing on every PRINT.
+ *
+ * @date May 4, 2025
+ */
+
+#ifndef OUTPUT_HPP
+#define OUTPUT_HPP
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+/**
+ * @enum FlushPolicy
+ *
+ * When an output buffer hands what it holds to its stream:
+ *  - FLUSH_ON_EXIT: only when the machine is done, or before an error is reported.
+ *  - FLUSH_ON_THRESHOLD: whenever HardcodedValues::get_output_buffer_size() bytes are pending.
+ *  - FLUSH_ON_LINE: after every printed value, for interactive use.
+ */
+enum FlushPolicy : uint8_t {
+    FLUSH_ON_EXIT,
+    FLUSH_ON_THRESHOLD,
+    FLUSH_ON_LINE,
+};
+
+inline constexpr array<string_view, FLUSH_ON_LINE + 1> FLUSH_POLICIES_NAMES = {"exit", "threshold",
+                                                                               "line"};
+
+/**
+ * @enum OutputFormat
+ *
+ * How printed values are written:
+ *  - OUTPUT_TEXT: in decimal, one per line.
+ *  - OUTPUT_BINARY: as 2-byte records, the value in little-endian order.
+ *  - OUTPUT_INDEXED: as 6-byte records, the index of the PRINT instruction in the program as
+ * a little-endian uint32 followed by the value as a little-endian uint16.
+ */
+enum OutputFormat : uint8_t {
+    OUTPUT_TEXT,
+    OUTPUT_BINARY,
+    OUTPUT_INDEXED,
+};
+
+inline constexpr array<string_view, OUTPUT_INDEXED + 1> OUTPUT_FORMATS_NAMES = {"text", "binary",
+                                                                                "indexed"};
+
+/**
+ * @class OutputBuffer
+ *
+ * Collects printed values in the output format and writes them to a stream in as few
+ * writes as the flush policy allows. Whatever is pending is flushed on destruction.
+ */
+class OutputBuffer {
+    ostream& stream;
+    size_t threshold;  // pending bytes that trigger a flush, from the policy
+    OutputFormat format;
+    string buffer;
+
+   public:
+    explicit OutputBuffer(ostream& stream, FlushPolicy policy = FLUSH_ON_THRESHOLD,
+                          OutputFormat format = OUTPUT_TEXT);
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+    ~OutputBuffer();
+
+    void print(uint16_t value, size_t instruction_index);
+    void flush();
+
+    static FlushPolicy get_default_policy();
+    static optional<FlushPolicy> find_policy(string_view name);
+    static optional<OutputFormat> find_format(string_view name);
+};
+
+/**
+ * Appends a printed value in the output format, then flushes if the policy says so
+ *
+ * @param value The printed value
+ * @param instruction_index The index of the PRINT instruction, for indexed records
+ */
+inline void OutputBuffer::print(const uint16_t value, const size_t instruction_index) {
+    char record[6];  // "65535\n", or a uint32 index and a uint16 value
+    char* end = record;
+
+    if (format == OUTPUT_TEXT) {
+        end = to_chars(record, record + sizeof(record) - 1, value).ptr;
+        *end++ = '\n';
+    } else {
+        if (format == OUTPUT_INDEXED) {
+            const auto index = static_cast<uint32_t>(instruction_index);
+
+            for (size_t byte = 0; byte < sizeof(uint32_t); ++byte) {
+                *end++ = static_cast<char>(index >> (8 * byte));
+            }
+        }
+
+        *end++ = static_cast<char>(value);
+        *end++ = static_cast<char>(value >> 8);
+    }
+
+    buffer.append(record, end);
+
+    if (buffer.size() >= threshold) flush();
+}
+
+#endif
@@ -0,0 +1,326 @@
+/**
+ * @file scheduler.cpp
+ *
+ * This file implements the Chase-Lev deque and the work-stealing scheduler. The memory
+ * orders of the deque follow "Correct and Efficient Work-Stealing for Weak Memory Models"
+ * (Le et al., PPoPP 2013): the owner's pop and a thief's steal only contend, through a CAS
+ * on top, for the last task of a deque.
+ *
+ * @date May 4, 2025
+ */
+
+#include "scheduler.hpp"
+
+#include <iomanip>
+
+#include "values.hpp"
+
+using namespace std;
+
+/**
+ * Allocates a buffer of tasks
+ *
+ * @param capacity The number of tasks the buffer holds, a power of two
+ */
+WorkStealingDeque::Buffer::Buffer(const size_t capacity)
+    : capacity(capacity), tasks(make_unique<atomic<uint64_t>[]>(capacity)) {}
+
+/**
+ * Reads the task at a deque index
+ *
+ * @param index The deque index, wrapped around the buffer
+ * @return uint64_t The task
+ */
+uint64_t WorkStealingDeque::Buffer::get(const int64_t index) const {
+    return tasks[static_cast<size_t>(index) & (capacity - 1)].load(memory_order_relaxed);
+}
+
+/**
+ * Writes the task at a deque index
+ *
+ * @param index The deque index, wrapped around the buffer
+ * @param task The task
+ */
+void WorkStealingDeque::Buffer::put(const int64_t index, const uint64_t task) {
+    tasks[static_cast<size_t>(index) & (capacity - 1)].store(task, memory_order_relaxed);
+}
+
+/**
+ * Constructor for the WorkStealingDeque class
+ */
+WorkStealingDeque::WorkStealingDeque() {
+    buffers.push_back(make_unique<Buffer>(INITIAL_CAPACITY));
+    buffer.store(buffers.back().get(), memory_order_relaxed);
+}
+
+/**
+ * Replaces a full buffer with one twice as large holding the same tasks
+ *
+ * @param current The full buffer
+ * @param top_index The index of the oldest task
+ * @param bottom_index The index past the newest task
+ * @return Buffer* The new buffer
+ */
+WorkStealingDeque::Buffer* WorkStealingDeque::grow(Buffer* const current, const int64_t top_index,
+                                                   const int64_t bottom_index) {
+    buffers.push_back(make_unique<Buffer>(current -> capacity * 2));
+    Buffer* const grown = buffers.back().get();
+
+    for (int64_t index = top_index; index < bottom_index; ++index) {
+        grown -> put(index, current -> get(index));
+    }
+
+    buffer.store(grown, memory_order_release);
+
+    return grown;
+}
+
+/**
+ * Adds a task at the bottom of the deque. Owner only.
+ *
+ * @param task The task
+ */
+void WorkStealingDeque::push(const uint64_t task) {
+    const int64_t bottom_index = bottom.load(memory_order_relaxed);
+    const int64_t top_index = top.load(memory_order_acquire);
+    Buffer* current = buffer.load(memory_order_relaxed);
+
+    if (bottom_index - top_index > static_cast<int64_t>(current -> capacity) - 1) {
+        current = grow(current, top_index, bottom_index);
+    }
+
+    current -> put(bottom_index, task);
+    atomic_thread_fence(memory_order_release);
+    bottom.store(bottom_index + 1, memory_order_relaxed);
+}
+
+/**
+ * Takes the newest task from the bottom of the deque. Owner only.
+ *
+ * @return optional<uint64_t> The task, or nullopt if the deque is empty
+ */
+optional<uint64_t> WorkStealingDeque::pop() {
+    const int64_t bottom_index = bottom.load(memory_order_relaxed) - 1;
+    Buffer* const current = buffer.load(memory_order_relaxed);
+    bottom.store(bottom_index, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t top_index = top.load(memory_order_relaxed);
+
+    if (top_index > bottom_index) {
+        bottom.store(bottom_index + 1, memory_order_relaxed);
+        return nullopt;
+    }
+
+    const uint64_t task = current -> get(bottom_index);
+
+    if (top_index < bottom_index) return task;
+
+    // The last task: a thief may be taking it at the same time
+    const bool is_taken = top.compare_exchange_strong(top_index, top_index + 1,
+                                                      memory_order_seq_cst, memory_order_relaxed);
+    bottom.store(bottom_index + 1, memory_order_relaxed);
+
+    if (!is_taken) return nullopt;
+
+    return task;
+}
+
+/**
+ * Takes the oldest task from the top of the deque. Any thread.
+ *
+ * @return optional<uint64_t> The task, or nullopt if the deque is empty or another thread
+ * took the task first
+ */
+optional<uint64_t> WorkStealingDeque::steal() {
+    int64_t top_index = top.load(memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    const int64_t bottom_index = bottom.load(memory_order_acquire);
+
+    if (top_index >= bottom_index) return nullopt;
+
+    const uint64_t task = buffer.load(memory_order_acquire) -> get(top_index);
+
+    if (!top.compare_exchange_strong(top_index, top_index + 1, memory_order_seq_cst,
+                                     memory_order_relaxed)) {
+        return nullopt;
+    }
+
+    return task;
+}
+
+/**
+ * Constructor for the WorkStealingScheduler class
+ *
+ * @param workers_number The number of worker threads, at least 1
+ */
+WorkStealingScheduler::WorkStealingScheduler(const size_t workers_number)
+    : deques(workers_number), stats(workers_number) {}
+
+/**
+ * Destructor for the WorkStealingScheduler class. Waits for the workers if they still run.
+ */
+WorkStealingScheduler::~WorkStealingScheduler() {
+    join();
+}
+
+/**
+ * Adds a task before the workers start. Tasks are dealt to the workers in turn.
+ *
+ * @param task The task
+ */
+void WorkStealingScheduler::submit(const Task task) {
+    pending_tasks.fetch_add(1, memory_order_relaxed);
+    deques[next_deque].push(task);
+    next_deque = (next_deque + 1) % deques.size();
+}
+
+/**
+ * Adds a task from inside a running task, to the deque of the worker running it, where an
+ * idle worker may steal it.
+ *
+ * @param task The task
+ * @param worker The worker the calling task runs on
+ */
+void WorkStealingScheduler::spawn(const Task task, const size_t worker) {
+    pending_tasks.fetch_add(1, memory_order_relaxed);
+    deques[worker].push(task);
+
+    // Wake one idle worker to steal it
+    tasks_epoch.fetch_add(1, memory_order_release);
+    tasks_epoch.notify_one();
+}
+
+/**
+ * Starts the workers
+ *
+ * @param execute The function every task is executed with
+ */
+void WorkStealingScheduler::start(Execute execute) {
+    this -> execute = move(execute);
+    started = chrono::steady_clock::now();
+
+    for (size_t worker = 0; worker < deques.size(); ++worker) {
+        workers.emplace_back(&WorkStealingScheduler::work, this, worker);
+    }
+}
+
+/**
+ * Waits until every task has been executed and the workers have stopped
+ */
+void WorkStealingScheduler::join() {
+    if (workers.empty()) return;
+
+    for (thread& worker : workers) worker.join();
+
+    workers.clear();
+    elapsed = chrono::steady_clock::now() - started;
+}
+
+/**
+ * Tries to steal a task, visiting the other workers in turn starting from victim
+ *
+ * @param worker The stealing worker
+ * @param victim The next worker to steal from, advanced past the workers visited
+ * @return optional<Task> The stolen task, or nullopt if no deque had one
+ */
+optional<WorkStealingScheduler::Task> WorkStealingScheduler::steal_task(const size_t worker,
+                                                                        size_t& victim) {
+    for (size_t attempt = 1; attempt < deques.size(); ++attempt) {
+        victim = (victim + 1) % deques.size();
+
+        if (victim == worker) victim = (victim + 1) % deques.size();
+
+        if (const optional<Task> task = deques[victim].steal()) return task;
+    }
+
+    return nullopt;
+}
+
+/**
+ * Executes tasks, its own first and then stolen ones, until no task is left anywhere. A
+ * worker that finds nothing to run sleeps until a task is spawned or the last one ends,
+ * rather than spinning while other workers finish long tasks.
+ *
+ * @param worker The worker index
+ */
+void WorkStealingScheduler::work(const size_t worker) {
+    WorkerStats& worker_stats = stats[worker];
+    size_t victim = worker;
+
+    while (true) {
+        // Read before looking for a task, so that a task spawned meanwhile ends the wait
+        const uint32_t epoch = tasks_epoch.load(memory_order_acquire);
+
+        if (pending_tasks.load(memory_order_acquire) == 0) return;
+
+        optional<Task> task = deques[worker].pop();
+        const bool is_stolen = !task;
+
+        if (is_stolen) task = steal_task(worker, victim);
+
+        if (!task) {
+            tasks_epoch.wait(epoch, memory_order_acquire);
+            continue;
+        }
+
+        const chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+        execute(*task, worker);
+        worker_stats.busy += chrono::steady_clock::now() - begin;
+        ++worker_stats.tasks;
+        worker_stats.stolen += is_stolen;
+
+        // The last task wakes every idle worker to stop
+        if (pending_tasks.fetch_sub(1, memory_order_acq_rel) == 1) {
+            tasks_epoch.fetch_add(1, memory_order_release);
+            tasks_epoch.notify_all();
+        }
+    }
+}
+
+/**
+ * Returns what every worker did during the last run
+ *
+ * @return const vector<WorkerStats>&: The statistics, indexed by worker
+ */
+const vector<WorkerStats>& WorkStealingScheduler::get_stats() const {
+    return stats;
+}
+
+/**
+ * Returns the wall time of the last run
+ *
+ * @return chrono::nanoseconds: The time from start to join
+ */
+chrono::nanoseconds WorkStealingScheduler::get_elapsed() const {
+    return elapsed;
+}
+
+/**
+ * Writes one line per worker: tasks executed, tasks stolen, and the share of the run the
+ * worker spent executing tasks
+ *
+ * @param report The stream to write to
+ */
+void WorkStealingScheduler::print_report(ostream& report) const {
+    const double elapsed_seconds = chrono::duration<double>(elapsed).count();
+    const ios::fmtflags flags = report.flags();
+    const streamsize precision = report.precision();
+
+    for (size_t worker = 0; worker < stats.size(); ++worker) {
+        const double busy_seconds = chrono::duration<double>(stats[worker].busy).count();
+        const double utilization =
+            elapsed_seconds > 0 ? 100 * busy_seconds / elapsed_seconds : 0;
+
+        report << ErrorMessages::get_worker_report_message() << worker
+               << ErrorMessages::get_report_separator_message() << stats[worker].tasks
+               << ErrorMessages::get_worker_report_tasks_message() << stats[worker].stolen
+               << ErrorMessages::get_worker_report_stolen_message() << fixed << setprecision(3)
+               << busy_seconds << ErrorMessages::get_worker_report_elapsed_message()
+               << elapsed_seconds << ErrorMessages::get_report_seconds_message()
+               << setprecision(1) << utilization
+               << ErrorMessages::get_worker_report_utilization_message() << endl;
+    }
+
+    report.flags(flags);
+    report.precision(precision);
+}
@@ -0,0 +1,116 @@
+/**
+ * @file scheduler.hpp
+ *
+ * This file declares the work-stealing scheduler the batch runner executes its tasks on.
+ * Every worker thread owns a Chase-Lev deque: it pushes and pops tasks at the bottom of its
+ * own deque, and when that is empty it steals from the top of another worker's deque. Long
+ * and short tasks therefore even out across the workers without any static split.
+ *
+ * @date May 4, 2025
+ */
+
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @class WorkStealingDeque
+ *
+ * A Chase-Lev deque of tasks, as formulated for C11 atomics by Le, Pop, Cohen and Zappa
+ * Nardelli. Only the owner calls push and pop; any thread may call steal. The buffer grows
+ * when it is full, and replaced buffers are kept until the deque is destroyed, since a
+ * thief may still be reading from one.
+ */
+class WorkStealingDeque {
+    struct Buffer {
+        size_t capacity;
+        unique_ptr<atomic<uint64_t>[]> tasks;
+
+        explicit Buffer(size_t capacity);
+        uint64_t get(int64_t index) const;
+        void put(int64_t index, uint64_t task);
+    };
+
+    static constexpr size_t INITIAL_CAPACITY = 64;
+
+    atomic<int64_t> top = 0;
+    atomic<int64_t> bottom = 0;
+    atomic<Buffer*> buffer;
+    vector<unique_ptr<Buffer>> buffers;
+
+    Buffer* grow(Buffer* current, int64_t top_index, int64_t bottom_index);
+
+   public:
+    WorkStealingDeque();
+
+    void push(uint64_t task);
+    optional<uint64_t> pop();
+    optional<uint64_t> steal();
+};
+
+/**
+ * @struct WorkerStats
+ *
+ * What one worker did during a run: how many tasks it executed, how many of them it stole
+ * from other workers, and how long it spent executing them.
+ */
+struct WorkerStats {
+    size_t tasks = 0;
+    size_t stolen = 0;
+    chrono::nanoseconds busy = chrono::nanoseconds::zero();
+};
+
+/**
+ * @class WorkStealingScheduler
+ *
+ * Runs tasks on a fixed set of worker threads until every task, including the ones spawned
+ * by running tasks, has been executed. A task is an opaque 64-bit value that the execute
+ * function interprets.
+ */
+class WorkStealingScheduler {
+   public:
+    using Task = uint64_t;
+    using Execute = function<void(Task task, size_t worker)>;
+
+   private:
+    vector<WorkStealingDeque> deques;
+    vector<WorkerStats> stats;
+    vector<thread> workers;
+    Execute execute;
+    atomic<size_t> pending_tasks = 0;
+    atomic<uint32_t> tasks_epoch = 0;  // bumped when a task is spawned or the last one ends
+    size_t next_deque = 0;
+    chrono::steady_clock::time_point started;
+    chrono::nanoseconds elapsed = chrono::nanoseconds::zero();
+
+    void work(size_t worker);
+    optional<Task> steal_task(size_t worker, size_t& victim);
+
+   public:
+    explicit WorkStealingScheduler(size_t workers_number);
+    WorkStealingScheduler(const WorkStealingScheduler&) = delete;
+    WorkStealingScheduler& operator=(const WorkStealingScheduler&) = delete;
+    ~WorkStealingScheduler();
+
+    void submit(Task task);
+    void spawn(Task task, size_t worker);
+    void start(Execute execute);
+    void join();
+
+    const vector<WorkerStats>& get_stats() const;
+    chrono::nanoseconds get_elapsed() const;
+    void print_report(ostream& report) const;
+};
+
+#endif
@@ -0,0 +1,72 @@
+/**
+ * @file snapshot.cpp
+ *
+ * This file implements machine snapshots on top of the memory images of Memory.
+ *
+ * @date May 4, 2025
+ */
+
+#include "snapshot.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "values.hpp"
+
+using namespace std;
+
+/**
+ * Takes a snapshot of a machine, exiting if it cannot be written. The image file is sized
+ * with ftruncate and only the memory and the values on the stack are written to it, so the
+ * unused part of a deep stack takes no space.
+ *
+ * @param machine The machine to save the state of
+ */
+Snapshot::Snapshot(const Machine& machine)
+    : descriptor(memfd_create("up3k-snapshot", MFD_CLOEXEC)),
+      stack_pointer(machine.memory.get_stack_pointer()) {
+    if (descriptor < 0 ||
+        ftruncate(descriptor, static_cast<off_t>(machine.memory.get_image_size())) != 0 ||
+        !machine.memory.write_image(descriptor)) {
+        cerr << ErrorMessages::get_snapshot_error() << endl;
+        exit(ExitStatusCodes::get_failure_exit_status());
+    }
+
+    for (uint16_t id = 0; id < RegistersManager::REGISTERS_NUMBER; ++id) {
+        registers[id] = machine.registers[id];
+    }
+}
+
+/**
+ * Destructor for the Snapshot class. Machines restored from the snapshot keep their mappings
+ * of the image file, which lives on until they are gone.
+ *
+ * @return void: Nothing
+ */
+Snapshot::~Snapshot() {
+    close(descriptor);
+}
+
+/**
+ * Restores a machine to the snapshot, exiting if the image cannot be mapped. The machine's
+ * error is cleared; its output is left as is.
+ *
+ * @param machine The machine to restore, of the same memory and stack sizes as the one the
+ * snapshot was taken of
+ * @return void: Nothing
+ */
+void Snapshot::restore(Machine& machine) const {
+    if (!machine.memory.map_image(descriptor, stack_pointer)) {
+        cerr << ErrorMessages::get_snapshot_error() << endl;
+        exit(ExitStatusCodes::get_failure_exit_status());
+    }
+
+    for (uint16_t id = 0; id < RegistersManager::REGISTERS_NUMBER; ++id) {
+        machine.registers[id] = registers[id];
+    }
+
+    machine.error = {};
+    machine.error_program_counter = 0;
+}
@@ -0,0 +1,47 @@
+/**
+ * @file snapshot.hpp
+ *
+ * This file declares machine snapshots. A snapshot saves the registers, the memory and the
+ * stack of a machine, stack pointer included, into an anonymous memfd. Restoring it maps the
+ * file back over the memory and the stack with MAP_PRIVATE, so nothing is copied up front:
+ * pages are shared with the snapshot until the machine writes to them. Restoring the same
+ * snapshot over and over thus only costs the pages touched in between, whatever the memory
+ * size.
+ *
+ * @date May 4, 2025
+ */
+
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <array>
+#include <cstdint>
+
+#include "hardware.hpp"
+#include "machine.hpp"
+
+using namespace std;
+
+/**
+ * @class Snapshot
+ *
+ * The state of a machine at one point, which any machine of the same memory and stack sizes
+ * can be restored to, any number of times. A machine only runs whole programs, so there is no
+ * program counter to save: a snapshot is taken between programs. What the machine printed
+ * is not part of it.
+ */
+class Snapshot {
+    int descriptor;
+    size_t stack_pointer;
+    array<uint16_t, RegistersManager::REGISTERS_NUMBER> registers;
+
+   public:
+    explicit Snapshot(const Machine& machine);
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+    ~Snapshot();
+
+    void restore(Machine& machine) const;
+};
+
+#endif
@@ -8,7 +8,7 @@
  * interacts with a virtual memory module.
  *
  * Key responsibilities implemented in this file include:
- *  - Reading a program file line by line and parsing each instruction.
+ *  - Reading a program file line by line and decoding it into a Program before execution.
  *  - Tokenizing instruction strings to identify opcodes and operands.
  *  - Supporting various instructions such as:
  *      * SETv: Set a register to an immediate value.
@@ -33,138 +33,1096 @@
 
 #include "software.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csetjmp>
+#include <exception>
+#include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
 #include <sstream>
+#include <system_error>
+#include <thread>
+#include <utility>
 #include <vector>
 
+#include "batch.hpp"
+#include "bytecode.hpp"
+#include "cache.hpp"
+#include "guard.hpp"
+#include "handlers.hpp"
 #include "hardware.hpp"
+#include "jit.hpp"
+#include "loader.hpp"
+#include "machine.hpp"
 #include "memory.hpp"
+#include "multi_instance.hpp"
+#include "snapshot.hpp"
 #include "values.hpp"
 
 using namespace std;
 
-auto RAM = Memory(HardcodedValues::get_memory_size());
+/**
+ * Labels of the threaded interpreter, one per specialized handler family. The GUARDED ones
+ * push and pop a guarded stack without bounds checks. CHECKED runs an instruction through the
+ * validating proceed_* path.
+ */
+enum ThreadedHandler : uint8_t {
+    SET_NUMERIC,
+    SET_REGISTER,
+    ADD_NUMERIC,
+    ADD_REGISTER,
+    SUB_NUMERIC,
+    SUB_REGISTER,
+    IFNZ_REGISTER,
+    PRINT_REGISTER,
+    PUSH_REGISTER,
+    POP_REGISTER,
+    LOAD_REGISTER,
+    STORE_REGISTER,
+    GUARDED_PUSH_REGISTER,
+    GUARDED_POP_REGISTER,
+    CHECKED,
+};
+
+/**
+ * Maps a dispatch table index to the label that runs the same handler specialization.
+ *
+ * @param index An index into HANDLERS
+ * @return ThreadedHandler The label, CHECKED if the operand types do not fit the opcode
+ */
+constexpr ThreadedHandler get_threaded_handler(const size_t index) {
+    const auto opcode = static_cast<Opcode>(index / (OPERAND_TYPES_NUMBER * OPERAND_TYPES_NUMBER));
+    const bool is_numeric_second = index % OPERAND_TYPES_NUMBER == NUMERIC;
+
+    if (HANDLERS[index] == nullptr) return CHECKED;
+
+    switch (opcode) {
+        case SETv:
+        case SETr:
+            return is_numeric_second ? SET_NUMERIC : SET_REGISTER;
+        case ADDv:
+        case ADDr:
+            return is_numeric_second ? ADD_NUMERIC : ADD_REGISTER;
+        case SUBv:
+        case SUBr:
+            return is_numeric_second ? SUB_NUMERIC : SUB_REGISTER;
+        case IFNZ:
+            return IFNZ_REGISTER;
+        case PRINT:
+            return PRINT_REGISTER;
+        case PUSH:
+            return PUSH_REGISTER;
+        case POP:
+            return POP_REGISTER;
+        case LOAD:
+            return LOAD_REGISTER;
+        case STORE:
+            return STORE_REGISTER;
+    }
+
+    return CHECKED;
+}
+
+/**
+ * Builds the table that maps dispatch table indices to threaded interpreter labels.
+ *
+ * @return array<ThreadedHandler, HANDLERS_NUMBER> The table, indexed by get_handler_index
+ */
+constexpr array<ThreadedHandler, HANDLERS_NUMBER> build_threaded_handlers() {
+    array<ThreadedHandler, HANDLERS_NUMBER> table = {};
+
+    for (size_t index = 0; index < HANDLERS_NUMBER; ++index) {
+        table[index] = get_threaded_handler(index);
+    }
+
+    return table;
+}
+
+constexpr array<ThreadedHandler, HANDLERS_NUMBER> THREADED_HANDLERS = build_threaded_handlers();
 
 /**
- * Executes the program in the text file
+ * Reads the program file and decodes every instruction in it, exiting if the program is
+ * malformed
  * @param program_path The path to the file where the program is stored
+ * @param options The loader to read the file with, and whether to report the load throughput
+ * @returns Program The decoded program
+ */
+Program functools::load(const string& program_path, const LoadOptions& options) {
+    optional<Program> program = decode(program_path, cerr, options);
+
+    if (!program) exit(ExitStatusCodes::get_failure_exit_status());
+
+    return move(*program);
+}
+
+/**
+ * Decodes one line of a program file into the program. Empty lines are skipped.
+ * @param line The line, without its newline
+ * @param line_number The 1-based number of the line in the file
+ * @param program The program to append the instruction to
+ * @param errors The stream errors are reported to
+ * @returns bool false if the opcode is unknown or an operand is neither a register nor a
+ * uint16 literal
+ */
+bool functools::decode_line(const string_view line, const size_t line_number, Program& program,
+                            ostream& errors) {
+    if (line.empty()) return true;
+
+    const Tokens tokens = tokenize(line, HardcodedValues::get_delimiter_symbol());
+    const string_view opcode = tokens.items[HardcodedValues::get_first_item_index()];
+
+    if (!is_opcode(opcode)) {
+        errors << ErrorMessages::get_unknown_opcode_error() << opcode << endl;
+        return false;
+    }
+
+    for (size_t i = HardcodedValues::get_first_operand_index(); i < tokens.count; ++i) {
+        const string_view token = tokens.items[i];
+
+        if (!RegistersManager::find_register(token) && !parse_number(token)) {
+            errors << ErrorMessages::get_invalid_number_error() << token
+                   << ErrorMessages::get_at_line_message() << line_number << endl;
+            return false;
+        }
+    }
+
+    program.decoded_instructions.emplace_back(tokens);
+    program.decoded_lines.push_back(line_number);
+    return true;
+}
+
+/**
+ * @struct DecodedChunk
+ *
+ * One newline-aligned part of a program text decoded on its own thread, with line numbers
+ * counted from the start of the part, and where its instructions and lines go in the whole
+ * program. A part that fails keeps its exception, to be rethrown only if no earlier part
+ * failed; its error message is numbered from the start of the part, so it is discarded.
+ */
+struct DecodedChunk {
+    string_view text;
+    Program program;
+    ostringstream errors;
+    exception_ptr exception;
+    size_t lines_number = 0;
+    size_t first_line = 0;
+    size_t first_instruction = 0;
+    bool is_decoded = false;
+};
+
+/**
+ * Runs a task once per index, each on its own thread, the first one on the calling thread
+ * @param count The number of indices
+ * @param task The task, called with every index below count
  * @returns void
  */
-void functools::exec(const string& program_path) {
-    ifstream file(program_path);
+template <typename Task>
+void run_on_threads(const size_t count, const Task& task) {
+    vector<jthread> threads;
+    threads.reserve(count);
 
-    if (!file) {
-        cerr << ErrorMessages::get_unable_to_open_file_error() << program_path << endl;
+    for (size_t index = 1; index < count; ++index) threads.emplace_back(task, index);
+
+    task(0);
+}
+
+/**
+ * Decodes the lines of a program text into the program, numbering them after first_line.
+ * Stops at the first unknown opcode.
+ * @param text The program text
+ * @param first_line The number of lines before the text
+ * @param program The program to append the instructions to
+ * @param errors The stream errors are reported to
+ * @param lines_number Incremented for every line of the text
+ * @returns bool false if an opcode is unknown
+ */
+bool functools::decode_lines(string_view text, const size_t first_line, Program& program,
+                             ostream& errors, size_t& lines_number) {
+    while (!text.empty()) {
+        const size_t newline = text.find('\n');
+        const string_view line = text.substr(0, newline);
+
+        text.remove_prefix(newline == string_view::npos ? text.size() : newline + 1);
+
+        if (!decode_line(line, first_line + ++lines_number, program, errors)) return false;
+    }
+
+    return true;
+}
+
+/**
+ * Decodes a whole program text. In parallel, the text is cut right after the newlines
+ * closest to equal parts, one per core but none smaller than
+ * HardcodedValues::get_decode_chunk_min_size(). Every part is decoded on its own thread into
+ * its own arrays, which are then copied into the program side by side, shifting the line
+ * numbers of every part by the lines before it. The error reported, if any, is the one of
+ * the first failing part, which is the one a sequential decoding would have stopped at. That
+ * part is decoded again from the line it starts at in the text, so that the error reports
+ * the same line as a sequential decoding would.
+ * @param text The program text
+ * @param is_parallel Whether to decode the text on all cores
+ * @param program The program to decode into, empty
+ * @param errors The stream errors are reported to
+ * @param lines_number Set to the number of lines of the text
+ * @returns bool false if an opcode is unknown
+ */
+bool functools::decode_text(const string_view text, const bool is_parallel, Program& program,
+                            ostream& errors, size_t& lines_number) {
+    const size_t cores_number = max<size_t>(thread::hardware_concurrency(), 1);
+    const size_t chunks_number =
+        is_parallel ? clamp<size_t>(text.size() / HardcodedValues::get_decode_chunk_min_size(), 1,
+                                    cores_number)
+                    : 1;
+
+    if (chunks_number == 1) return decode_lines(text, 0, program, errors, lines_number);
+
+    vector<DecodedChunk> chunks(chunks_number);
+
+    for (size_t index = 0, begin = 0; index < chunks_number; ++index) {
+        size_t end = text.size();
+
+        if (index + 1 < chunks_number) {
+            end = text.find('\n', max(begin, text.size() / chunks_number * (index + 1)));
+            end = end == string_view::npos ? text.size() : end + 1;
+        }
+
+        chunks[index].text = text.substr(begin, end - begin);
+        begin = end;
+    }
+
+    run_on_threads(chunks_number, [&](const size_t index) {
+        DecodedChunk& chunk = chunks[index];
+
+        try {
+            chunk.is_decoded =
+                decode_lines(chunk.text, 0, chunk.program, chunk.errors, chunk.lines_number);
+        } catch (...) {
+            chunk.exception = current_exception();
+        }
+    });
+
+    size_t instructions_number = 0;
+
+    for (DecodedChunk& chunk : chunks) {
+        if (chunk.exception) rethrow_exception(chunk.exception);
+
+        if (!chunk.is_decoded) {
+            // Decode the part again, now that the lines before it are known, to report the
+            // error with its line in the whole text
+            Program discarded;
+            size_t chunk_lines_number = 0;
+
+            decode_lines(chunk.text, lines_number, discarded, errors, chunk_lines_number);
+            lines_number += chunk_lines_number;
+            return false;
+        }
+
+        chunk.first_line = lines_number;
+        chunk.first_instruction = instructions_number;
+        lines_number += chunk.lines_number;
+        instructions_number += chunk.program.decoded_instructions.size();
+    }
+
+    program.decoded_instructions.resize(instructions_number);
+    program.decoded_lines.resize(instructions_number);
+
+    run_on_threads(chunks_number, [&](const size_t index) {
+        const DecodedChunk& chunk = chunks[index];
+        const Program& part = chunk.program;
+        const auto offset = static_cast<ptrdiff_t>(chunk.first_instruction);
+
+        copy(part.decoded_instructions.begin(), part.decoded_instructions.end(),
+             program.decoded_instructions.begin() + offset);
+        transform(part.decoded_lines.begin(), part.decoded_lines.end(),
+                  program.decoded_lines.begin() + offset,
+                  [&](const size_t line) { return chunk.first_line + line; });
+    });
+
+    return true;
+}
+
+/**
+ * Reads the program file, decodes every instruction in it and verifies the result. Stops at
+ * the first unknown opcode; otherwise reports every malformed instruction. With the parallel
+ * and mmap loaders the instructions are decoded straight out of the mapped file, on all
+ * cores or on one; files that cannot be mapped are read with getline, as the stream loader
+ * does. A bytecode file is not decoded
+ * at all: a mapped one is executed in place. With a cache directory, a mapped program text
+ * that was decoded before is loaded from its cache entry, and a new one is cached once it
+ * is verified.
+ * @param program_path The path to the file where the program is stored
+ * @param errors The stream errors are reported to
+ * @param options The loader to read the file with, whether to report the load throughput
+ * and the cache directory
+ * @returns optional<Program> The verified program, or nullopt if it is malformed
+ */
+optional<Program> functools::decode(const string& program_path, ostream& errors,
+                                    const LoadOptions& options) {
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    shared_ptr<const MappedFile> mapping;
+
+    if (options.loader != LOADER_STREAM) mapping = make_shared<const MappedFile>(program_path);
+
+    Program program;
+    size_t bytes = 0;
+    size_t line_number = 0;
+    bool is_bytecode = false;
+    bool is_cached = false;
+    string cache_entry_path;
+
+    if (mapping && mapping->is_mapped()) {
+        string_view text = mapping->get_text();
+        bytes = text.size();
+        is_bytecode = Bytecode::is_bytecode(text);
+
+        if (is_bytecode && !Bytecode::read(program_path, text, mapping, program, errors))
+            return nullopt;
+
+        if (!is_bytecode && !options.cache_directory.empty()) {
+            cache_entry_path = ProgramCache::get_entry_path(options.cache_directory, text);
+            is_cached = ProgramCache::read(cache_entry_path, program);
+        }
+
+        if (!is_bytecode && !is_cached &&
+            !decode_text(text, options.loader == LOADER_PARALLEL, program, errors, line_number))
+            return nullopt;
+    } else {
+        ifstream file(program_path, ios::binary);
+
+        if (!file) {
+            errors << ErrorMessages::get_unable_to_open_file_error() << program_path << endl;
+            return nullopt;
+        }
+
+        string line;
+        bool is_line = static_cast<bool>(getline(file, line));
+        is_bytecode = is_line && Bytecode::is_bytecode(line);
+
+        if (is_bytecode) {
+            // The newline getline stopped at is part of the bytecode
+            string contents = move(line);
+
+            if (!file.eof()) contents.push_back('\n');
+
+            contents.append(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+            bytes = contents.size();
+
+            if (!Bytecode::read(program_path, contents, nullptr, program, errors)) return nullopt;
+        }
+
+        for (; !is_bytecode && is_line; is_line = static_cast<bool>(getline(file, line))) {
+            bytes += line.size() + (file.eof() ? 0 : 1);
+
+            if (!decode_line(line, ++line_number, program, errors)) return nullopt;
+        }
+    }
+
+    const bool is_parsed = !is_bytecode && !is_cached;
+
+    if (is_parsed) {
+        program.instructions = program.decoded_instructions;
+        program.lines = program.decoded_lines;
+    }
+
+    if (!verify(program, errors, options.memory_size)) return nullopt;
+
+    if (is_parsed && !cache_entry_path.empty()) ProgramCache::write(cache_entry_path, program);
+
+    if (options.is_report) {
+        const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        const size_t records_number = is_parsed ? line_number : program.instructions.size();
+        report_load(program_path, bytes, records_number, elapsed.count(), errors);
+    }
+
+    return program;
+}
+
+/**
+ * Writes how long loading a program file took and the resulting throughput
+ * @param program_path The path to the loaded program file
+ * @param bytes The size of the file
+ * @param lines_number The number of lines in the file, or of instructions in a bytecode file
+ * @param seconds The time spent reading, decoding and verifying the file
+ * @param report The stream to write to
+ * @returns void
+ */
+void functools::report_load(const string& program_path, const size_t bytes,
+                            const size_t lines_number, const double seconds, ostream& report) {
+    const ios::fmtflags flags = report.flags();
+    const streamsize precision = report.precision();
+    const double megabytes = static_cast<double>(bytes) / 1e6;
+    const double rate_seconds = seconds > 0 ? seconds : numeric_limits<double>::min();
+
+    report << ErrorMessages::get_load_report_message() << program_path
+           << ErrorMessages::get_report_separator_message() << bytes
+           << ErrorMessages::get_load_report_bytes_message() << lines_number
+           << ErrorMessages::get_load_report_lines_message() << fixed << setprecision(3)
+           << seconds << ErrorMessages::get_report_seconds_message() << setprecision(1)
+           << megabytes / rate_seconds << ErrorMessages::get_load_report_megabytes_rate_message()
+           << setprecision(0) << static_cast<double>(lines_number) / rate_seconds
+           << ErrorMessages::get_load_report_lines_rate_message() << endl;
+
+    report.flags(flags);
+    report.precision(precision);
+}
+
+/**
+ * Checks every instruction of the program for everything that can be known before running
+ * it: operand count, operand types and memory addresses. Reports every malformed instruction
+ * with its line; if there is none, marks the program as verified for that memory size.
+ * @param program The program to verify
+ * @param errors The stream errors are reported to
+ * @param memory_size The memory size of the machines the program is meant to run on
+ * @returns bool true if the program is verified
+ */
+bool functools::verify(Program& program, ostream& errors, const size_t memory_size) {
+    bool is_valid = true;
+
+    for (size_t i = 0; i < program.instructions.size(); ++i) {
+        is_valid = verify_instruction(program.instructions[i], program.get_line(i), memory_size,
+                                      errors) &&
+                   is_valid;
+    }
+
+    program.verified = is_valid;
+    program.memory_size = memory_size;
+
+    return is_valid;
+}
+
+/**
+ * Checks one instruction, reporting what is wrong with it
+ * @param instruction The instruction to check
+ * @param line The source line of the instruction
+ * @param memory_size The memory size addresses must fit in
+ * @param errors The stream errors are reported to
+ * @returns bool true if the instruction is valid
+ */
+bool functools::verify_instruction(const Instruction& instruction, const size_t line,
+                                   const size_t memory_size, ostream& errors) {
+    const Operand first_operand = instruction.operand(HardcodedValues::get_first_item_index());
+    const Operand second_operand = instruction.operand(HardcodedValues::get_second_item_index());
+
+    if (select_handler(instruction) == nullptr) {
+        const bool is_heap_opcode = instruction.opcode == LOAD || instruction.opcode == STORE;
+        const bool is_one_operand_opcode = instruction.opcode == IFNZ ||
+                                           instruction.opcode == PRINT ||
+                                           instruction.opcode == PUSH || instruction.opcode == POP;
+        const OperandType expected_first_type = is_heap_opcode ? NUMERIC : REGISTER;
+
+        if (first_operand.type == NONE || (!is_one_operand_opcode && second_operand.type == NONE)) {
+            errors << ErrorMessages::get_nullptr_operand_error();
+        } else if (first_operand.type != expected_first_type) {
+            errors << ErrorMessages::get_invalid_first_operand_type_error();
+        } else {
+            errors << ErrorMessages::get_invalid_second_operand_type_error();
+        }
+
+        errors << ErrorMessages::get_at_line_message() << line << endl;
+        return false;
+    }
+
+    if (instruction.opcode != LOAD && instruction.opcode != STORE) return true;
+
+    const size_t address = first_operand.parsed;
+
+    if (address + sizeof(uint16_t) > memory_size) {
+        errors << ErrorMessages::get_address_out_of_range_error() << address
+               << ErrorMessages::get_at_line_message() << line << endl;
+        return false;
+    }
+
+    return true;
+}
+
+#if defined(__GNUC__)
+// Labels as values are a GNU extension; they are the whole point of the threaded interpreter.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+
+/**
+ * Jumps to the label of the instruction at ip in the threaded interpreter, or returns once
+ * ip has run past the last instruction, which an IFNZ in the last instruction may do
+ */
+#define DISPATCH()                                                                           \
+    do {                                                                                     \
+        if (ip >= end) return;                                                               \
+        goto *labels[get_handler_index(ip -> opcode, ip -> types[0], ip -> types[1])];       \
+    } while (false)
+
+/**
+ * Executes a decoded program. A verified program runs on a threaded interpreter straight out
+ * of program.instructions, so a mapped bytecode program is executed in place: the label
+ * that runs the specialized handler of every instruction (see handlers.hpp) is looked up by
+ * its dispatch table index, and each label jumps straight to the label of the next
+ * instruction. Other programs are validated instruction by instruction as they run. On a
+ * guarded stack, PUSH and POP do not check its bounds: a StackGuard catches the fault on the
+ * guard page instead. A fault stops the program with machine.error set.
+ * @param machine The machine to run the program on
+ * @param program The program to execute
+ * @returns void
+ */
+void functools::run(Machine& machine, const Program& program) {
+    if (!program.is_verified_for(machine.memory.get_size())) {
+        run_checked(machine, program);
+        return;
+    }
+
+    // Indexed by ThreadedHandler
+    static const void* const LABELS[] = {
+        &&set_numeric,  &&set_register,   &&add_numeric,   &&add_register, &&sub_numeric,
+        &&sub_register, &&ifnz_register,  &&print_register, &&push_register, &&pop_register,
+        &&load_register, &&store_register, &&guarded_push_register, &&guarded_pop_register,
+        &&checked,
+    };
+
+    const span<const Instruction> instructions = program.instructions;
+    const bool is_stack_guarded = machine.memory.is_stack_guarded();
+
+    // Indexed by get_handler_index
+    const void* labels[HANDLERS_NUMBER];
+
+    for (size_t index = 0; index < HANDLERS_NUMBER; ++index) {
+        ThreadedHandler handler = THREADED_HANDLERS[index];
+
+        if (is_stack_guarded && handler == PUSH_REGISTER) handler = GUARDED_PUSH_REGISTER;
+        if (is_stack_guarded && handler == POP_REGISTER) handler = GUARDED_POP_REGISTER;
+
+        labels[index] = LABELS[handler];
+    }
+
+    const Instruction* ip = instructions.data();
+    const Instruction* const end = ip + instructions.size();
+    const auto program_counter = [&]() { return static_cast<size_t>(ip - instructions.data()); };
+
+    // The guarded PUSH or POP that last ran, which is the one that faulted after a jump
+    const Instruction* volatile stack_instruction = nullptr;
+    optional<StackGuard> guard;
+
+    if (is_stack_guarded) {
+        guard.emplace(machine.memory);
+
+        if (sigsetjmp(guard -> jump, 1) != 0) {
+            machine.error = guard -> error;
+            machine.error_program_counter =
+                static_cast<size_t>(stack_instruction - instructions.data());
+            return;
+        }
+    }
+
+    DISPATCH();
+
+set_numeric:
+    ip += execute<SETv, REGISTER, NUMERIC>(machine, *ip, program_counter());
+    DISPATCH();
+
+set_register:
+    ip += execute<SETv, REGISTER, REGISTER>(machine, *ip, program_counter());
+    DISPATCH();
+
+add_numeric:
+    ip += execute<ADDv, REGISTER, NUMERIC>(machine, *ip, program_counter());
+    DISPATCH();
+
+add_register:
+    ip += execute<ADDv, REGISTER, REGISTER>(machine, *ip, program_counter());
+    DISPATCH();
+
+sub_numeric:
+    ip += execute<SUBv, REGISTER, NUMERIC>(machine, *ip, program_counter());
+    DISPATCH();
+
+sub_register:
+    ip += execute<SUBv, REGISTER, REGISTER>(machine, *ip, program_counter());
+    DISPATCH();
+
+ifnz_register:
+    ip += execute<IFNZ, REGISTER, NONE>(machine, *ip, program_counter());
+    DISPATCH();
+
+print_register:
+    ip += execute<PRINT, REGISTER, NONE>(machine, *ip, program_counter());
+    DISPATCH();
+
+push_register:
+    ip += execute<PUSH, REGISTER, NONE>(machine, *ip, program_counter());
+    if (!machine.error.empty()) return;
+    DISPATCH();
+
+pop_register:
+    ip += execute<POP, REGISTER, NONE>(machine, *ip, program_counter());
+    if (!machine.error.empty()) return;
+    DISPATCH();
+
+load_register:
+    ip += execute<LOAD, NUMERIC, REGISTER>(machine, *ip, program_counter());
+    DISPATCH();
+
+store_register:
+    ip += execute<STORE, NUMERIC, REGISTER>(machine, *ip, program_counter());
+    DISPATCH();
+
+guarded_push_register:
+    stack_instruction = ip;
+    atomic_signal_fence(memory_order_seq_cst);
+    machine.memory.push_unchecked(machine.registers[ip -> values[0]]);
+    ++ip;
+    DISPATCH();
+
+guarded_pop_register:
+    stack_instruction = ip;
+    atomic_signal_fence(memory_order_seq_cst);
+    machine.registers[ip -> values[0]] = machine.memory.pop_unchecked();
+    ++ip;
+    DISPATCH();
+
+checked: {
+    size_t checked_counter = program_counter();
+    proceed_instruction(machine, *ip, checked_counter);
+    ip = instructions.data() + checked_counter + 1;
+    DISPATCH();
+}
+}
+
+#undef DISPATCH
+
+#pragma GCC diagnostic pop
+#else
+/**
+ * Executes a decoded program one instruction at a time, through the HANDLERS dispatch table
+ * if the program is verified. A fault stops the program with machine.error set.
+ * @param machine The machine to run the program on
+ * @param program The program to execute
+ * @returns void
+ */
+void functools::run(Machine& machine, const Program& program) {
+    if (!program.is_verified_for(machine.memory.get_size())) {
+        run_checked(machine, program);
+        return;
+    }
+
+    const span<const Instruction> instructions = program.instructions;
+
+    for (size_t program_counter = 0; program_counter < instructions.size();) {
+        const Instruction& instruction = instructions[program_counter];
+
+        if (const Handler handler = select_handler(instruction)) {
+            program_counter += handler(machine, instruction, program_counter);
+
+            if (!machine.error.empty()) return;
+        } else {
+            proceed_instruction(machine, instruction, program_counter);
+            ++program_counter;
+        }
+    }
+}
+#endif
+
+/**
+ * Executes a program that has not been verified, validating every instruction as it runs
+ * @param machine The machine to run the program on
+ * @param program The program to execute
+ * @returns void
+ */
+void functools::run_checked(Machine& machine, const Program& program) {
+    const span<const Instruction> instructions = program.instructions;
+
+    for (size_t program_counter = 0; program_counter < instructions.size(); ++program_counter) {
+        // Any instruction may exit the process, so nothing may be left pending
+        machine.output.flush();
+        proceed_instruction(machine, instructions[program_counter], program_counter);
+    }
+
+    machine.output.flush();
+}
+
+/**
+ * Validates and executes a single instruction
+ * @param machine The machine to run the instruction on
+ * @param instruction The instruction to execute
+ * @param program_counter Index of the instruction, advanced by IFNZ when it skips
+ * @returns void
+ */
+void functools::proceed_instruction(Machine& machine, const Instruction& instruction,
+                                    size_t& program_counter) {
+    const Operand first_operand =
+        instruction.operand(HardcodedValues::get_first_item_index());
+    const Operand second_operand =
+        instruction.operand(HardcodedValues::get_second_item_index());
+
+    // Proceed the instruction based on its opcode
+    switch (instruction.opcode) {
+        case SETv:
+        case SETr:
+            validate_two_operands_present(instruction);
+            proceed_set_opcode(machine, first_operand, second_operand);
+            break;
+
+        case ADDv:
+        case ADDr:
+            validate_two_operands_present(instruction);
+            proceed_add_opcode(machine, first_operand, second_operand);
+            break;
+
+        case SUBv:
+        case SUBr:
+            validate_two_operands_present(instruction);
+            proceed_sub_opcode(machine, first_operand, second_operand);
+            break;
+
+        case IFNZ:
+            validate_one_operand_present(instruction);
+            proceed_ifnz_opcode(machine, first_operand, program_counter);
+            break;
+
+        case PRINT:
+            validate_one_operand_present(instruction);
+            proceed_print_opcode(machine, first_operand, program_counter);
+            break;
+
+        case PUSH:
+            validate_one_operand_present(instruction);
+            proceed_push_opcode(machine, first_operand);
+            break;
+
+        case POP:
+            validate_one_operand_present(instruction);
+            proceed_pop_opcode(machine, first_operand);
+            break;
+
+        case LOAD:
+            validate_two_operands_present(instruction);
+            proceed_load_opcode(machine, first_operand, second_operand);
+            break;
+
+        case STORE:
+            validate_two_operands_present(instruction);
+            proceed_store_opcode(machine, first_operand, second_operand);
+            break;
+    }
+}
+
+/**
+ * Compiles a program to native code and executes it, falling back to the interpreter if
+ * the JIT does not support the program or the machine. A fault stops the program with
+ * machine.error set, as in the interpreter.
+ * @param machine The machine to run the program on
+ * @param program The program to execute
+ * @returns void
+ */
+void functools::run_native(Machine& machine, const Program& program) {
+    if (!program.is_verified_for(machine.memory.get_size()) || !JitProgram::is_supported(program)) {
+        run(machine, program);
+        return;
+    }
+
+    JitProgram(program, machine.memory.is_stack_guarded()).run(machine);
+}
+
+/**
+ * Executes the program in the text file on the given machine, exiting if the program is
+ * malformed or faults
+ * @param machine The machine to run the program on
+ * @param program_path The path to the file where the program is stored
+ * @param use_jit Whether to compile the program to native code instead of interpreting it
+ * @param options The loader to read the file with, and whether to report the load throughput
+ * @returns void
+ */
+void functools::exec(Machine& machine, const string& program_path, const bool use_jit,
+                     const LoadOptions& options) {
+    if (!run_file(machine, program_path, use_jit, cerr, options))
         exit(ExitStatusCodes::get_failure_exit_status());
+}
+
+/**
+ * Executes the prefix program once, then every continuation program from the state the
+ * prefix left the machine in: a snapshot is taken after the prefix and the machine is
+ * restored to it before each continuation. Continuations run in order on the given machine,
+ * so their output is written in order too. A continuation that fails has its errors written
+ * to stderr prefixed with its path, and does not stop the others. Exits if the prefix fails
+ * or once the continuations are done, if any of them failed.
+ * @param machine The machine to run the programs on
+ * @param prefix_path The path to the file where the prefix program is stored
+ * @param program_paths The paths to the files where the continuation programs are stored
+ * @param use_jit Whether to compile the programs to native code instead of interpreting them
+ * @param options The loader to read the files with, and whether to report the load throughput
+ * @returns void
+ */
+void functools::exec_continuations(Machine& machine, const string& prefix_path,
+                                   const vector<string>& program_paths, const bool use_jit,
+                                   const LoadOptions& options) {
+    exec(machine, prefix_path, use_jit, options);
+
+    const Snapshot snapshot(machine);
+    bool is_succeeded = true;
+
+    for (const string& program_path : program_paths) {
+        snapshot.restore(machine);
+
+        ostringstream program_errors;
+
+        if (run_file(machine, program_path, use_jit, program_errors, options)) continue;
+
+        string_view lines = program_errors.view();
+
+        while (!lines.empty()) {
+            const size_t end = lines.find('\n');
+            cerr << program_path << ": " << lines.substr(0, end) << '\n';
+            lines = end == string_view::npos ? string_view() : lines.substr(end + 1);
+        }
+
+        cerr.flush();
+        is_succeeded = false;
     }
 
-    string line;
-
-    while (getline(file, line)) {
-        // Skip empty lines
-        if (line.empty()) continue;
-
-        Instruction instruction(line);
-
-        // Proceed the instruction based on its opcode
-        switch (instruction.opcode) {
-            case SETv:
-            case SETr:
-                validate_two_operands_non_nullptr(instruction.operands);
-                proceed_set_opcode(instruction.operands[HardcodedValues::get_first_item_index()],
-                                   instruction.operands[HardcodedValues::get_second_item_index()]);
-                break;
-
-            case ADDv:
-            case ADDr:
-                validate_two_operands_non_nullptr(instruction.operands);
-                proceed_add_opcode(instruction.operands[HardcodedValues::get_first_item_index()],
-                                   instruction.operands[HardcodedValues::get_second_item_index()]);
-                break;
-
-            case SUBv:
-            case SUBr:
-                validate_two_operands_non_nullptr(instruction.operands);
-                proceed_sub_opcode(instruction.operands[HardcodedValues::get_first_item_index()],
-                                   instruction.operands[HardcodedValues::get_second_item_index()]);
-                break;
-
-            case IFNZ:
-                validate_one_operand_non_nullptr(
-                    instruction.operands[HardcodedValues::get_first_item_index()]);
-                proceed_ifnz_opcode(instruction.operands[HardcodedValues::get_first_item_index()],
-                                    file, line);
-                break;
-
-            case PRINT:
-                validate_one_operand_non_nullptr(
-                    instruction.operands[HardcodedValues::get_first_item_index()]);
-                proceed_print_opcode(instruction.operands[HardcodedValues::get_first_item_index()]);
-                break;
-
-            case PUSH:
-                validate_one_operand_non_nullptr(
-                    instruction.operands[HardcodedValues::get_first_item_index()]);
-                proceed_push_opcode(instruction.operands[HardcodedValues::get_first_item_index()]);
-                break;
-
-            case POP:
-                validate_one_operand_non_nullptr(
-                    instruction.operands[HardcodedValues::get_first_item_index()]);
-                proceed_pop_opcode(instruction.operands[HardcodedValues::get_first_item_index()]);
-                break;
-
-            case LOAD:
-                validate_two_operands_non_nullptr(instruction.operands);
-                proceed_load_opcode(instruction.operands[HardcodedValues::get_first_item_index()],
-                                    instruction.operands[HardcodedValues::get_second_item_index()]);
-                break;
-
-            case STORE:
-                validate_two_operands_non_nullptr(instruction.operands);
-                proceed_store_opcode(
-                    instruction.operands[HardcodedValues::get_first_item_index()],
-                    instruction.operands[HardcodedValues::get_second_item_index()]);
-                break;
+    if (!is_succeeded) exit(ExitStatusCodes::get_failure_exit_status());
+}
+
+/**
+ * Executes the program in the text file on the given machine, reporting why it could not be
+ * loaded or why it stopped instead of exiting
+ * @param machine The machine to run the program on
+ * @param program_path The path to the file where the program is stored
+ * @param use_jit Whether to compile the program to native code instead of interpreting it
+ * @param errors The stream errors are reported to
+ * @param options The loader to read the file with, and whether to report the load throughput
+ * @returns bool true if the program was loaded and ran to its end
+ */
+bool functools::run_file(Machine& machine, const string& program_path, const bool use_jit,
+                         ostream& errors, const LoadOptions& options) {
+    const optional<Program> program = decode(program_path, errors, options);
+
+    if (!program) return false;
+
+    if (use_jit)
+        run_native(machine, *program);
+    else
+        run(machine, *program);
+
+    machine.output.flush();
+
+    if (machine.error.empty()) return true;
+
+    errors << machine.error << ErrorMessages::get_at_line_message()
+           << program->get_line(machine.error_program_counter) << endl;
+    return false;
+}
+
+/**
+ * Executes every program of a batch on a pool of worker threads, one machine per program.
+ * The batch is either a directory, whose regular files run in name order, or a file listing
+ * one program path per line. A listed program may be followed by a tab and a memory images
+ * file to run it once per image, as with --instances. The output of every program is
+ * written in batch order, as if the programs had run one after another; errors are written
+ * prefixed with the program path.
+ * @param batch_path The path to the batch directory or list file
+ * @param output The stream program output is written to
+ * @param format How the programs write printed values
+ * @param is_workers_report Whether to write how busy every worker was to stderr at the end
+ * @param load_options How to load the program files
+ * @returns void
+ */
+void functools::exec_batch(const string& batch_path, ostream& output, const OutputFormat format,
+                           const bool is_workers_report, const LoadOptions& load_options) {
+    vector<BatchEntry> entries;
+    error_code error;
+
+    if (filesystem::is_directory(batch_path, error)) {
+        for (const filesystem::directory_entry& entry :
+             filesystem::directory_iterator(batch_path, error)) {
+            if (entry.is_regular_file()) entries.push_back({entry.path().string(), ""});
+        }
+
+        sort(entries.begin(), entries.end(), [](const BatchEntry& left, const BatchEntry& right) {
+            return left.program_path < right.program_path;
+        });
+    } else {
+        ifstream file(batch_path);
+
+        if (!file) {
+            cerr << ErrorMessages::get_unable_to_open_file_error() << batch_path << endl;
+            exit(ExitStatusCodes::get_failure_exit_status());
+        }
+
+        string line;
+
+        while (getline(file, line)) {
+            // Skip empty lines
+            if (line.empty()) continue;
+
+            const size_t separator = line.find('\t');
+
+            if (separator == string::npos)
+                entries.push_back({line, ""});
+            else
+                entries.push_back({line.substr(0, separator), line.substr(separator + 1)});
         }
     }
+
+    if (!BatchRunner::run(entries, output, cerr, format, is_workers_report, load_options))
+        exit(ExitStatusCodes::get_failure_exit_status());
 }
 
 /**
- * Helper method to get a register by its ID
- * @param id The register ID
- * @return Pointer to the register
+ * Assembles the program file into a bytecode file, exiting if the program is malformed or
+ * the bytecode file cannot be written
+ * @param program_path The path to the file where the program is stored
+ * @param bytecode_path The path to write the bytecode file to
+ * @param options The loader to read the program file with, and whether to report the load
+ * throughput
+ * @returns void
  */
-Register* functools::get_register_by_id(const uint16_t id) {
-    if (const set<string> registers = RegistersManager::get_registers_symbols();id < registers.size()) {
-        return RegistersManager::get_registers()[*next(registers.begin(), id)];
+void functools::assemble(const string& program_path, const string& bytecode_path,
+                         const LoadOptions& options) {
+    const Program program = load(program_path, options);
+    ofstream bytecode_file(bytecode_path, ios::binary);
+
+    if (bytecode_file) Bytecode::write(program, bytecode_file);
+
+    if (!bytecode_file.flush()) {
+        cerr << ErrorMessages::get_unable_to_open_file_error() << bytecode_path << endl;
+        exit(ExitStatusCodes::get_failure_exit_status());
     }
+}
 
-    cerr << ErrorMessages::get_invalid_register_id_error() << endl;
-    exit(ExitStatusCodes::get_failure_exit_status());
+/**
+ * Writes the program in a program file or a bytecode file as text, exiting if the program is
+ * malformed
+ * @param program_path The path to the file where the program is stored
+ * @param output The stream to write the text to
+ * @param options The loader to read the file with, and whether to report the load throughput
+ * @returns void
+ */
+void functools::disassemble(const string& program_path, ostream& output,
+                            const LoadOptions& options) {
+    Bytecode::write_text(load(program_path, options), output);
+    output.flush();
 }
 
 /**
- * Validates that the operand is not a nullptr
- * @param operands operands to validate
+ * Executes the program in the text file once per memory image in the images file, all
+ * instances at once. The images file is the concatenation of the initial memory of every
+ * instance. Each printed value is written as "<instance> <value>", instance by instance.
+ * @param program_path The path to the file where the program is stored
+ * @param images_path The path to the memory images file
+ * @param output The stream printed values are written to
+ * @param options The loader to read the file with, and whether to report the load throughput
  * @returns void
  */
-void functools::validate_two_operands_non_nullptr(const Operand* operands[2]) {
-    if (operands[HardcodedValues::get_first_item_index()] == nullptr ||
-        operands[HardcodedValues::get_second_item_index()] == nullptr) {
+void functools::exec_instances(const string& program_path, const string& images_path,
+                               ostream& output, const LoadOptions& options) {
+    const Program program = load(program_path, options);
+    const optional<vector<vector<uint8_t>>> images =
+        read_images(images_path, options.memory_size, cerr);
+
+    if (!images) exit(ExitStatusCodes::get_failure_exit_status());
+
+    if (!write_instance_results(
+            MultiInstanceEngine::run(program, *images, options.memory_size, options.stack_size),
+            output, cerr))
+        exit(ExitStatusCodes::get_failure_exit_status());
+}
+
+/**
+ * Reads a memory images file: the concatenation of the initial memory of every instance
+ * @param images_path The path to the memory images file
+ * @param memory_size The size of every image
+ * @param errors The stream errors are reported to
+ * @returns optional<vector<vector<uint8_t>>> One image per instance, or nullopt if the file
+ * cannot be read or does not hold whole images
+ */
+optional<vector<vector<uint8_t>>> functools::read_images(const string& images_path,
+                                                         const size_t memory_size,
+                                                         ostream& errors) {
+    ifstream file(images_path, ios::binary);
+
+    if (!file) {
+        errors << ErrorMessages::get_unable_to_open_file_error() << images_path << endl;
+        return nullopt;
+    }
+
+    const vector<uint8_t> bytes((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    if (bytes.size() % memory_size != 0) {
+        errors << ErrorMessages::get_instance_images_size_error() << bytes.size() << endl;
+        return nullopt;
+    }
+
+    vector<vector<uint8_t>> images;
+
+    for (size_t offset = 0; offset < bytes.size(); offset += memory_size) {
+        images.emplace_back(bytes.begin() + static_cast<ptrdiff_t>(offset),
+                            bytes.begin() + static_cast<ptrdiff_t>(offset + memory_size));
+    }
+
+    return images;
+}
+
+/**
+ * Writes what every instance printed as "<instance> <value>" lines, and the error of every
+ * instance that failed as "<instance> <error> at line <line>"
+ * @param results The results of the instances, in instance order
+ * @param output The stream printed values are written to
+ * @param errors The stream errors are written to
+ * @returns bool true if no instance failed
+ */
+bool functools::write_instance_results(const vector<InstanceResult>& results, ostream& output,
+                                       ostream& errors) {
+    bool is_failed = false;
+
+    for (size_t instance = 0; instance < results.size(); ++instance) {
+        for (const uint16_t value : results[instance].printed) {
+            output << instance << ' ' << value << '\n';
+        }
+
+        if (!results[instance].error.empty()) {
+            output.flush();
+            errors << instance << ' ' << results[instance].error
+                   << ErrorMessages::get_at_line_message() << results[instance].error_line << endl;
+            is_failed = true;
+        }
+    }
+
+    output.flush();
+
+    return !is_failed;
+}
+
+/**
+ * Helper method to get a register by its ID
+ * @param machine The machine that owns the register
+ * @param id The register ID
+ * @return Reference to the register
+ */
+Register& functools::get_register_by_id(Machine& machine, const uint16_t id) {
+    return machine.registers[id];
+}
+
+/**
+ * Validates that the instruction has both operands
+ * @param instruction Instruction to validate
+ * @returns void
+ */
+void functools::validate_two_operands_present(const Instruction& instruction) {
+    if (instruction.operands_number < Instruction::MAX_OPERANDS_NUMBER) {
         cerr << ErrorMessages::get_nullptr_operand_error() << endl;
         exit(ExitStatusCodes::get_failure_exit_status());
     }
 };
 
 /**
- * Validates that the operand is not a nullptr
- * @param operand Operand to validate
+ * Validates that the instruction has its first operand
+ * @param instruction Instruction to validate
  * @returns void
  */
-void functools::validate_one_operand_non_nullptr(const Operand* operand) {
-    if (operand == nullptr) {
+void functools::validate_one_operand_present(const Instruction& instruction) {
+    if (instruction.operands_number == 0) {
         cerr << ErrorMessages::get_nullptr_operand_error() << endl;
         exit(ExitStatusCodes::get_failure_exit_status());
     }
@@ -174,8 +1132,8 @@ void functools::validate_one_operand_non_nullptr(const Operand* operand) {
  * Validates the first operand type
  * @param operand Operand to validate
  */
-void functools::validate_first_operand_type(const Operand* operand) {
-    if (operand -> type != REGISTER) {
+void functools::validate_first_operand_type(const Operand& operand) {
+    if (operand.type != REGISTER) {
         cerr << ErrorMessages::get_invalid_first_operand_type_error() << endl;
         exit(ExitStatusCodes::get_failure_exit_status());
     }
@@ -187,10 +1145,10 @@ void functools::validate_first_operand_type(const Operand* operand) {
  * @param second_operand Second operand to validate
  * @returns void
  */
-void functools::validate_heap_opcodes_operands_types(const Operand* first_operand,
-                                                     const Operand* second_operand) {
-    if (first_operand -> type != NUMERIC ||
-        second_operand -> type != REGISTER) {
+void functools::validate_heap_opcodes_operands_types(const Operand& first_operand,
+                                                     const Operand& second_operand) {
+    if (first_operand.type != NUMERIC ||
+        second_operand.type != REGISTER) {
         cerr << ErrorMessages::get_invalid_first_operand_type_error() << endl;
         cerr << ErrorMessages::get_invalid_second_operand_type_error() << endl;
         exit(ExitStatusCodes::get_failure_exit_status());
@@ -199,21 +1157,23 @@ void functools::validate_heap_opcodes_operands_types(const Operand* first_operan
 
 /**
  * Proceeds SETv/SETr opcodes
+ * @param machine The machine to run the instruction on
  * @param first_operand First operand
  * @param second_operand Second operand
  */
-void functools::proceed_set_opcode(const Operand* first_operand, const Operand* second_operand) {
+void functools::proceed_set_opcode(Machine& machine, const Operand& first_operand,
+                                   const Operand& second_operand) {
     validate_first_operand_type(first_operand);
 
-    switch (second_operand -> type) {
+    switch (second_operand.type) {
         case NUMERIC:
-            *get_register_by_id(first_operand -> parsed) = second_operand -> parsed;
+            get_register_by_id(machine, first_operand.parsed) = second_operand.parsed;
 
             break;
 
         case REGISTER:
-            *get_register_by_id(first_operand -> parsed) =
-                static_cast<uint16_t>(*get_register_by_id(second_operand -> parsed));
+            get_register_by_id(machine, first_operand.parsed) =
+                static_cast<uint16_t>(get_register_by_id(machine, second_operand.parsed));
 
             break;
 
@@ -225,20 +1185,23 @@ void functools::proceed_set_opcode(const Operand* first_operand, const Operand*
 
 /**
  * Proceeds ADDv/ADDr opcodes
+ * @param machine The machine to run the instruction on
  * @param first_operand First operand
  * @param second_operand
  */
-void functools::proceed_add_opcode(const Operand* first_operand, const Operand* second_operand) {
+void functools::proceed_add_opcode(Machine& machine, const Operand& first_operand,
+                                   const Operand& second_operand) {
     validate_first_operand_type(first_operand);
 
-    switch (second_operand -> type) {
+    switch (second_operand.type) {
         case NUMERIC:
-            *get_register_by_id(first_operand -> parsed) += second_operand -> parsed;
+            get_register_by_id(machine, first_operand.parsed) += second_operand.parsed;
 
             break;
 
         case REGISTER:
-            *get_register_by_id(first_operand -> parsed) += *get_register_by_id(second_operand -> parsed);
+            get_register_by_id(machine, first_operand.parsed) +=
+                get_register_by_id(machine, second_operand.parsed);
 
             break;
 
@@ -250,20 +1213,23 @@ void functools::proceed_add_opcode(const Operand* first_operand, const Operand*
 
 /**
  * Proceeds SUB opcode
+ * @param machine The machine to run the instruction on
  * @param first_operand First operand
  * @param second_operand Second operand
  */
-void functools::proceed_sub_opcode(const Operand* first_operand, const Operand* second_operand) {
+void functools::proceed_sub_opcode(Machine& machine, const Operand& first_operand,
+                                   const Operand& second_operand) {
     validate_first_operand_type(first_operand);
 
-    switch (second_operand -> type) {
+    switch (second_operand.type) {
         case NUMERIC:
-            *get_register_by_id(first_operand -> parsed) -= second_operand -> parsed;
+            get_register_by_id(machine, first_operand.parsed) -= second_operand.parsed;
 
             break;
 
         case REGISTER:
-            *get_register_by_id(first_operand -> parsed) -= *get_register_by_id(second_operand -> parsed);
+            get_register_by_id(machine, first_operand.parsed) -=
+                get_register_by_id(machine, second_operand.parsed);
 
             break;
 
@@ -275,64 +1241,75 @@ void functools::proceed_sub_opcode(const Operand* first_operand, const Operand*
 
 /**
  * Proceeds PRINT opcode
+ * @param machine The machine to run the instruction on
  * @param operand An operand
+ * @param program_counter Index of the PRINT instruction
  */
-void functools::proceed_print_opcode(const Operand* operand) {
+void functools::proceed_print_opcode(Machine& machine, const Operand& operand,
+                                     const size_t program_counter) {
     validate_first_operand_type(operand);
 
-    cout << *get_register_by_id(operand -> parsed) << endl;
+    machine.output.print(get_register_by_id(machine, operand.parsed), program_counter);
 }
 
 /**
  * Proceeds IFNZ opcode
+ * @param machine The machine to run the instruction on
  * @param operand Operand to proceed
- * @param file ifstream file variable
- * @param line ifstream's string line variable
+ * @param program_counter Index of the IFNZ instruction, advanced past the next one if skipped
  */
-void functools::proceed_ifnz_opcode(const Operand* operand, ifstream& file, string& line) {
+void functools::proceed_ifnz_opcode(Machine& machine, const Operand& operand,
+                                    size_t& program_counter) {
     validate_first_operand_type(operand);
-    if (static_cast<uint16_t>(*get_register_by_id(operand -> parsed)) == 0) {
-        getline(file, line);
+    if (static_cast<uint16_t>(get_register_by_id(machine, operand.parsed)) == 0) {
+        ++program_counter;
     }
 }
 
 /**
  * Proceeds STORE opcode
+ * @param machine The machine to run the instruction on
  * @param first_operand First operand
  * @param second_operand Second operand
  */
-void functools::proceed_store_opcode(const Operand* first_operand, const Operand* second_operand) {
+void functools::proceed_store_opcode(Machine& machine, const Operand& first_operand,
+                                     const Operand& second_operand) {
     validate_heap_opcodes_operands_types(first_operand, second_operand);
-    RAM[static_cast<uint8_t>(first_operand -> parsed)] =
-        static_cast<uint16_t>(*get_register_by_id(second_operand -> parsed));
+    machine.memory.write(first_operand.parsed,
+                         static_cast<uint16_t>(get_register_by_id(machine, second_operand.parsed)));
 }
 
 /**
  * Proceeds LOAD opcode
+ * @param machine The machine to run the instruction on
  * @param first_operand First operand
  * @param second_operand Second operand
  */
-void functools::proceed_load_opcode(const Operand* first_operand, const Operand* second_operand) {
+void functools::proceed_load_opcode(Machine& machine, const Operand& first_operand,
+                                    const Operand& second_operand) {
     validate_heap_opcodes_operands_types(first_operand, second_operand);
-    *get_register_by_id(second_operand -> parsed) = RAM[static_cast<uint8_t>(first_operand -> parsed)];
+    get_register_by_id(machine, second_operand.parsed) =
+        machine.memory.read(first_operand.parsed);
 }
 
 /**
  * Proceeds PUSH opcode
+ * @param machine The machine to run the instruction on
  * @param operand An operand
  */
-void functools::proceed_push_opcode(const Operand* operand) {
+void functools::proceed_push_opcode(Machine& machine, const Operand& operand) {
     validate_first_operand_type(operand);
-    RAM.push(*get_register_by_id(operand -> parsed));
+    machine.memory.push(get_register_by_id(machine, operand.parsed));
 }
 
 /**
  * Proceeds POP opcode
+ * @param machine The machine to run the instruction on
  * @param operand An operand
  */
-void functools::proceed_pop_opcode(const Operand* operand) {
+void functools::proceed_pop_opcode(Machine& machine, const Operand& operand) {
     validate_first_operand_type(operand);
-    *get_register_by_id(operand -> parsed) = RAM.pop();
+    get_register_by_id(machine, operand.parsed) = machine.memory.pop();
 }
 
 /**
@@ -358,18 +1335,27 @@ bool functools::is_underflow(const uint16_t reg, const uint16_t number) {
 }
 
 /**
- * Splits a string into tokens
+ * Splits a string into tokens without copying it. Repeated delimiters are treated as one and
+ * tokens past Tokens::CAPACITY are ignored.
  * @param str a string to split
  * @param delimiter a delimiter to split the string by
- * @returns vector<string> a split string into tokens
+ * @returns Tokens views into str, one per token
  */
-vector<string> functools::split(const string& str, const char& delimiter) {
-    vector<string> tokens;
-    stringstream ss(str);
-    string token;
+Tokens functools::tokenize(const string_view str, const char delimiter) {
+    Tokens tokens;
+    size_t position = 0;
+
+    while (tokens.count < Tokens::CAPACITY) {
+        const size_t begin = str.find_first_not_of(delimiter, position);
+
+        if (begin == string_view::npos) break;
+
+        const size_t end = str.find(delimiter, begin);
+        tokens.items[tokens.count++] = str.substr(begin, end - begin);
+
+        if (end == string_view::npos) break;
 
-    while (getline(ss, token, delimiter)) {
-        tokens.push_back(token);
+        position = end;
     }
 
     return tokens;
@@ -13,49 +13,115 @@
 #ifndef SOFTWARE_HPP
 #define SOFTWARE_HPP
 
+#include <array>
 #include <fstream>
+#include <optional>
+#include <ostream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "hardware.hpp"
 #include "instructions.hpp"
+#include "loader.hpp"
+#include "machine.hpp"
+#include "multi_instance.hpp"
+#include "output.hpp"
 
 using namespace std;
 
+/**
+ * @struct Tokens
+ *
+ * The tokens of one instruction line. Each token is a view into the line it was cut from,
+ * so the line must outlive its tokens.
+ */
+struct Tokens {
+    static constexpr size_t CAPACITY = 3;  // opcode and up to two operands
+
+    array<string_view, CAPACITY> items;
+    size_t count = 0;
+};
+
 /**
  * A declarative class that declares all methods that must and will be used in software.cpp
  */
 class functools {
     // Helper methods
-    static Register* get_register_by_id(uint16_t id);
+    static Register& get_register_by_id(Machine& machine, uint16_t id);
 
     // Validation methods
-    static void validate_two_operands_non_nullptr(const Operand* operands[2]);
-    static void validate_one_operand_non_nullptr(const Operand* operand);
-    static void validate_first_operand_type(const Operand* operand);
-    static void validate_heap_opcodes_operands_types(const Operand* first_operand,
-                                                     const Operand* second_operand);
+    static void validate_two_operands_present(const Instruction& instruction);
+    static void validate_one_operand_present(const Instruction& instruction);
+    static void validate_first_operand_type(const Operand& operand);
+    static void validate_heap_opcodes_operands_types(const Operand& first_operand,
+                                                     const Operand& second_operand);
+    static bool verify_instruction(const Instruction& instruction, size_t line, size_t memory_size,
+                                   ostream& errors);
 
     // Opcode execution methods
-    static void proceed_set_opcode(const Operand* first_operand, const Operand* second_operand);
-    static void proceed_add_opcode(const Operand* first_operand, const Operand* second_operand);
-    static void proceed_sub_opcode(const Operand* first_operand, const Operand* second_operand);
-    static void proceed_print_opcode(const Operand* operand);
-    static void proceed_ifnz_opcode(const Operand* operand, ifstream& file, string& line);
-    static void proceed_store_opcode(const Operand* first_operand, const Operand* second_operand);
-    static void proceed_load_opcode(const Operand* first_operand, const Operand* second_operand);
-    static void proceed_push_opcode(const Operand* operand);
-    static void proceed_pop_opcode(const Operand* operand);
+    static void proceed_set_opcode(Machine& machine, const Operand& first_operand,
+                                   const Operand& second_operand);
+    static void proceed_add_opcode(Machine& machine, const Operand& first_operand,
+                                   const Operand& second_operand);
+    static void proceed_sub_opcode(Machine& machine, const Operand& first_operand,
+                                   const Operand& second_operand);
+    static void proceed_print_opcode(Machine& machine, const Operand& operand,
+                                     size_t program_counter);
+    static void proceed_ifnz_opcode(Machine& machine, const Operand& operand,
+                                    size_t& program_counter);
+    static void proceed_store_opcode(Machine& machine, const Operand& first_operand,
+                                     const Operand& second_operand);
+    static void proceed_load_opcode(Machine& machine, const Operand& first_operand,
+                                    const Operand& second_operand);
+    static void proceed_push_opcode(Machine& machine, const Operand& operand);
+    static void proceed_pop_opcode(Machine& machine, const Operand& operand);
+    static void proceed_instruction(Machine& machine, const Instruction& instruction,
+                                    size_t& program_counter);
+    static void run_checked(Machine& machine, const Program& program);
+    static bool decode_line(string_view line, size_t line_number, Program& program,
+                            ostream& errors);
+    static bool decode_lines(string_view text, size_t first_line, Program& program,
+                             ostream& errors, size_t& lines_number);
+    static bool decode_text(string_view text, bool is_parallel, Program& program, ostream& errors,
+                            size_t& lines_number);
+    static void report_load(const string& program_path, size_t bytes, size_t lines_number,
+                            double seconds, ostream& report);
 
    public:
-    static void exec(const string& program_path);
+    static Program load(const string& program_path, const LoadOptions& options = {});
+    static optional<Program> decode(const string& program_path, ostream& errors,
+                                    const LoadOptions& options = {});
+    static bool verify(Program& program, ostream& errors, size_t memory_size);
+    static void run(Machine& machine, const Program& program);
+    static void run_native(Machine& machine, const Program& program);
+    static void exec(Machine& machine, const string& program_path, bool use_jit = false,
+                     const LoadOptions& options = {});
+    static bool run_file(Machine& machine, const string& program_path, bool use_jit,
+                         ostream& errors, const LoadOptions& options = {});
+    static void exec_continuations(Machine& machine, const string& prefix_path,
+                                   const vector<string>& program_paths, bool use_jit,
+                                   const LoadOptions& options = {});
+    static void exec_batch(const string& batch_path, ostream& output, OutputFormat format,
+                           bool is_workers_report = false,
+                           const LoadOptions& load_options = {});
+    static void exec_instances(const string& program_path, const string& images_path,
+                               ostream& output, const LoadOptions& options = {});
+    static void assemble(const string& program_path, const string& bytecode_path,
+                         const LoadOptions& options = {});
+    static void disassemble(const string& program_path, ostream& output,
+                            const LoadOptions& options = {});
+    static optional<vector<vector<uint8_t>>> read_images(const string& images_path,
+                                                         size_t memory_size, ostream& errors);
+    static bool write_instance_results(const vector<InstanceResult>& results, ostream& output,
+                                       ostream& errors);
 
     // Arithmetic validation methods
     static bool is_overflow(uint16_t reg, uint16_t number);
     static bool is_underflow(uint16_t reg, uint16_t number);
 
     // String parsing methods
-    static vector<string> split(const string& str, const char& delimiter);
+    static Tokens tokenize(string_view str, char delimiter);
 };
 
 #endif
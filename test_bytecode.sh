@@ -0,0 +1,81 @@
+#!/bin/sh
+#
+# Checks that a program assembled into a .up3k bytecode file prints the same values as its
+# text, and that disassembling the bytecode gives the text back, empty lines included. A
+# bytecode file that is truncated, damaged or of another version must be rejected with its
+# error before anything runs.
+#
+# Usage: test_bytecode.sh <executable>
+#
+
+set -eu
+
+EXECUTABLE=$(realpath "$1")
+WORK_DIRECTORY=$(mktemp -d)
+trap 'rm -rf "$WORK_DIRECTORY"' EXIT
+
+cat > "$WORK_DIRECTORY/program.txt" << 'EOF'
+SETv a 5
+
+SETv b 10
+ADDv a 3
+ADDr a b
+PRINT a
+
+PUSH b
+STORE 100 a
+LOAD 100 c
+PRINT c
+SUBv c 18
+IFNZ c
+PRINT c
+POP d
+PRINT d
+EOF
+
+"$EXECUTABLE" --assemble "$WORK_DIRECTORY/program.txt" "$WORK_DIRECTORY/program.up3k"
+"$EXECUTABLE" "$WORK_DIRECTORY/program.txt" > "$WORK_DIRECTORY/text.out"
+"$EXECUTABLE" "$WORK_DIRECTORY/program.up3k" > "$WORK_DIRECTORY/bytecode.out"
+
+if ! cmp -s "$WORK_DIRECTORY/text.out" "$WORK_DIRECTORY/bytecode.out"; then
+    echo "FAIL: the bytecode printed other values than the text"
+    exit 1
+fi
+
+"$EXECUTABLE" --disassemble "$WORK_DIRECTORY/program.up3k" > "$WORK_DIRECTORY/disassembly.txt"
+
+if ! cmp -s "$WORK_DIRECTORY/program.txt" "$WORK_DIRECTORY/disassembly.txt"; then
+    echo "FAIL: the disassembly differs from the text"
+    exit 1
+fi
+
+SIZE=$(wc -c < "$WORK_DIRECTORY/program.up3k")
+
+head -c $((SIZE - 1)) "$WORK_DIRECTORY/program.up3k" > "$WORK_DIRECTORY/truncated.up3k"
+head -c 10 "$WORK_DIRECTORY/program.up3k" > "$WORK_DIRECTORY/header.up3k"
+cp "$WORK_DIRECTORY/program.up3k" "$WORK_DIRECTORY/damaged.up3k"
+printf '\377' | dd of="$WORK_DIRECTORY/damaged.up3k" bs=1 seek=40 conv=notrunc 2> /dev/null
+cp "$WORK_DIRECTORY/program.up3k" "$WORK_DIRECTORY/version.up3k"
+printf '\377' | dd of="$WORK_DIRECTORY/version.up3k" bs=1 seek=4 conv=notrunc 2> /dev/null
+
+for FILE in truncated:malformed header:malformed damaged:checksum version:version; do
+    NAME=${FILE%%:*}
+    ERROR=${FILE#*:}
+
+    # Running the file, then disassembling it
+    for MODE in "" --disassemble; do
+        if "$EXECUTABLE" $MODE "$WORK_DIRECTORY/$NAME.up3k" > "$WORK_DIRECTORY/rejected.out" \
+            2> "$WORK_DIRECTORY/errors.txt"; then
+            echo "FAIL ($NAME $MODE): the bytecode file was accepted"
+            exit 1
+        fi
+
+        if [ -s "$WORK_DIRECTORY/rejected.out" ] || ! grep -q "$ERROR" "$WORK_DIRECTORY/errors.txt"
+        then
+            echo "FAIL ($NAME $MODE): $(cat "$WORK_DIRECTORY/errors.txt")"
+            exit 1
+        fi
+    done
+done
+
+echo "PASS"
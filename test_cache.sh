@@ -0,0 +1,62 @@
+#!/bin/sh
+#
+# Checks that --cache stores a loaded program as the bytecode --assemble writes, that loading
+# the same text again runs the stored entry instead of decoding it, and that a damaged entry is
+# decoded again and replaced. A hit is told apart by swapping the entry for the bytecode of
+# another program, whose values are then printed.
+#
+# Usage: test_cache.sh <executable>
+#
+
+set -eu
+
+EXECUTABLE=$(realpath "$1")
+WORK_DIRECTORY=$(mktemp -d)
+trap 'rm -rf "$WORK_DIRECTORY"' EXIT
+
+CACHE_DIRECTORY="$WORK_DIRECTORY/cache"
+mkdir "$CACHE_DIRECTORY"
+
+printf 'SETv a 5\n\nSETv b 10\nADDr a b\nPRINT a\nPUSH b\nPOP c\nPRINT c\n' \
+    > "$WORK_DIRECTORY/program.txt"
+printf 'SETv a 7\nPRINT a\n' > "$WORK_DIRECTORY/other.txt"
+
+"$EXECUTABLE" --assemble "$WORK_DIRECTORY/program.txt" "$WORK_DIRECTORY/program.up3k"
+"$EXECUTABLE" --assemble "$WORK_DIRECTORY/other.txt" "$WORK_DIRECTORY/other.up3k"
+"$EXECUTABLE" "$WORK_DIRECTORY/program.txt" > "$WORK_DIRECTORY/expected.out"
+"$EXECUTABLE" "$WORK_DIRECTORY/other.txt" > "$WORK_DIRECTORY/other.out"
+
+# Runs the program with the cache and checks what it printed against the given file
+run_cached() {
+    "$EXECUTABLE" --cache "$CACHE_DIRECTORY" "$WORK_DIRECTORY/program.txt" \
+        > "$WORK_DIRECTORY/cached.out"
+
+    if ! cmp -s "$WORK_DIRECTORY/cached.out" "$1"; then
+        echo "FAIL ($2): the cached run printed $(cat "$WORK_DIRECTORY/cached.out")"
+        exit 1
+    fi
+}
+
+run_cached "$WORK_DIRECTORY/expected.out" "miss"
+
+set -- "$CACHE_DIRECTORY"/*.up3k
+
+if [ $# -ne 1 ] || ! cmp -s "$1" "$WORK_DIRECTORY/program.up3k"; then
+    echo "FAIL (miss): the cache does not hold the assembled program"
+    exit 1
+fi
+
+ENTRY=$1
+
+cp "$WORK_DIRECTORY/other.up3k" "$ENTRY"
+run_cached "$WORK_DIRECTORY/other.out" "hit"
+
+printf '\377' | dd of="$ENTRY" bs=1 seek=30 conv=notrunc 2> /dev/null
+run_cached "$WORK_DIRECTORY/expected.out" "damaged entry"
+
+if ! cmp -s "$ENTRY" "$WORK_DIRECTORY/program.up3k"; then
+    echo "FAIL (damaged entry): the entry was not replaced"
+    exit 1
+fi
+
+echo "PASS"
@@ -0,0 +1,93 @@
+#!/bin/sh
+#
+# Checks that --instances prints the same values and reports the same errors for every memory
+# image as running the program on its own from that image. Each image is also written as a
+# program that stores it word by word, which runs as the --prefix of the scalar run. The
+# programs and images are generated at random from a fixed seed.
+#
+# Usage: test_instances.sh <executable>
+#
+
+set -eu
+
+EXECUTABLE=$(realpath "$1")
+WORK_DIRECTORY=$(mktemp -d)
+trap 'rm -rf "$WORK_DIRECTORY"' EXIT
+
+INSTANCES=40
+
+for SEED in $(seq 1 20); do
+    awk -v seed="$SEED" 'BEGIN {
+        srand(seed)
+        split("SETv SETr ADDv ADDr SUBv SUBr IFNZ PRINT PRINT LOAD LOAD STORE PUSH POP", opcodes,
+              " ")
+        split("0 1 5 100 30000 40000 65535", values, " ")
+        for (line = 1; line <= 120; ++line) {
+            opcode = opcodes[1 + int(rand() * 14)]
+            register = substr("abcd", 1 + int(rand() * 4), 1)
+            # Mostly pop what was pushed, so that programs run past their first lines
+            if (opcode == "POP" && depth == 0 && rand() < 0.9)
+                opcode = "PUSH"
+            depth += opcode == "PUSH" ? 1 : opcode == "POP" ? -1 : 0
+            if (opcode ~ /v$/)
+                print opcode, register, values[1 + int(rand() * 7)]
+            else if (opcode ~ /r$/)
+                print opcode, register, substr("abcd", 1 + int(rand() * 4), 1)
+            else if (opcode == "LOAD" || opcode == "STORE")
+                print opcode, int(rand() * 255), register
+            else
+                print opcode, register
+        }
+    }' > "$WORK_DIRECTORY/program.txt"
+
+    # One line of octal escapes per image for printf, and one prefix program per image
+    awk -v seed="$SEED" -v instances="$INSTANCES" -v directory="$WORK_DIRECTORY" 'BEGIN {
+        srand(seed)
+        for (instance = 0; instance < instances; ++instance) {
+            escapes = ""
+            prefix = directory "/image" instance ".txt"
+            for (address = 0; address < 256; address += 2) {
+                low = rand() < 0.5 ? 0 : int(rand() * 256)
+                high = rand() < 0.5 ? 0 : int(rand() * 256)
+                escapes = escapes sprintf("\\%03o\\%03o", low, high)
+                print "SETv a", low + high * 256 > prefix
+                print "STORE", address, "a" > prefix
+            }
+            print "SETv a 0" > prefix
+            close(prefix)
+            print escapes
+        }
+    }' | while read -r ESCAPES; do
+        printf "$ESCAPES"
+    done > "$WORK_DIRECTORY/images.bin"
+
+    "$EXECUTABLE" --instances "$WORK_DIRECTORY/images.bin" "$WORK_DIRECTORY/program.txt" \
+        > "$WORK_DIRECTORY/instances.out" 2> "$WORK_DIRECTORY/instances.err" || true
+
+    : > "$WORK_DIRECTORY/scalar.out"
+    : > "$WORK_DIRECTORY/scalar.err"
+
+    INSTANCE=0
+    while [ "$INSTANCE" -lt "$INSTANCES" ]; do
+        "$EXECUTABLE" --prefix "$WORK_DIRECTORY/image$INSTANCE.txt" \
+            "$WORK_DIRECTORY/program.txt" 2>&1 > "$WORK_DIRECTORY/values.out" |
+            sed "s|^$WORK_DIRECTORY/program.txt:|$INSTANCE|" >> "$WORK_DIRECTORY/scalar.err" || true
+        sed "s/^/$INSTANCE /" "$WORK_DIRECTORY/values.out" >> "$WORK_DIRECTORY/scalar.out"
+        INSTANCE=$((INSTANCE + 1))
+    done
+
+    if ! cmp -s "$WORK_DIRECTORY/instances.out" "$WORK_DIRECTORY/scalar.out"; then
+        echo "FAIL (seed $SEED): the printed values differ"
+        exit 1
+    fi
+
+    sort "$WORK_DIRECTORY/instances.err" > "$WORK_DIRECTORY/instances.sorted"
+    sort "$WORK_DIRECTORY/scalar.err" > "$WORK_DIRECTORY/scalar.sorted"
+
+    if ! cmp -s "$WORK_DIRECTORY/instances.sorted" "$WORK_DIRECTORY/scalar.sorted"; then
+        echo "FAIL (seed $SEED): the errors differ"
+        exit 1
+    fi
+done
+
+echo "PASS"
@@ -0,0 +1,65 @@
+#!/bin/sh
+#
+# Checks that programs compiled with --jit print the same values, report the same errors and
+# exit with the same status as the interpreter, with the default stack and with a stack that
+# sits between guard pages. The programs are generated at random from a fixed seed.
+#
+# Usage: test_jit.sh <executable>
+#
+
+set -eu
+
+EXECUTABLE=$(realpath "$1")
+WORK_DIRECTORY=$(mktemp -d)
+trap 'rm -rf "$WORK_DIRECTORY"' EXIT
+
+# Runs the program with the given flags and writes its output, errors and exit status to the
+# files named after the given prefix
+run() {
+    PREFIX=$1
+    shift
+    STATUS=0
+    "$EXECUTABLE" "$@" "$WORK_DIRECTORY/program.txt" > "$WORK_DIRECTORY/$PREFIX.out" \
+        2> "$WORK_DIRECTORY/$PREFIX.err" || STATUS=$?
+    echo "$STATUS" > "$WORK_DIRECTORY/$PREFIX.status"
+}
+
+for SEED in $(seq 1 100); do
+    awk -v seed="$SEED" 'BEGIN {
+        srand(seed)
+        split("SETv SETr ADDv ADDr SUBv SUBr IFNZ PRINT PRINT PRINT LOAD STORE PUSH PUSH POP",
+              opcodes, " ")
+        split("0 1 5 100 30000 40000 65535", values, " ")
+        lines = 1 + int(rand() * 80)
+        for (line = 1; line <= lines; ++line) {
+            opcode = opcodes[1 + int(rand() * 15)]
+            register = substr("abcd", 1 + int(rand() * 4), 1)
+            # Mostly pop what was pushed, so that programs run past their first lines
+            if (opcode == "POP" && depth == 0 && rand() < 0.9)
+                opcode = "PUSH"
+            depth += opcode == "PUSH" ? 1 : opcode == "POP" ? -1 : 0
+            if (opcode ~ /v$/)
+                print opcode, register, values[1 + int(rand() * 7)]
+            else if (opcode ~ /r$/)
+                print opcode, register, substr("abcd", 1 + int(rand() * 4), 1)
+            else if (opcode == "LOAD" || opcode == "STORE")
+                print opcode, int(rand() * 255), register
+            else
+                print opcode, register
+        }
+    }' > "$WORK_DIRECTORY/program.txt"
+
+    for STACK_SIZE in 16 4096; do
+        run interpreter --stack-size "$STACK_SIZE"
+        run jit --jit --stack-size "$STACK_SIZE"
+
+        for SUFFIX in out err status; do
+            if ! cmp -s "$WORK_DIRECTORY/interpreter.$SUFFIX" "$WORK_DIRECTORY/jit.$SUFFIX"; then
+                echo "FAIL (seed $SEED, stack size $STACK_SIZE): the $SUFFIX files differ"
+                exit 1
+            fi
+        done
+    done
+done
+
+echo "PASS"
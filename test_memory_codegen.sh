@@ -0,0 +1,48 @@
+#!/bin/sh
+#
+# Checks that Memory::load and Memory::store compile to a single 16-bit move at -O2 on
+# x86-64, with no byte shuffling: load to one movzwl from memory, store to one movw to memory.
+# Skipped on other architectures.
+#
+# Usage: test_memory_codegen.sh <compiler> [flags...]
+#
+
+set -eu
+
+if [ "$(uname -m)" != "x86_64" ]; then
+    echo "SKIP: not x86-64"
+    exit 0
+fi
+
+WORK_DIRECTORY=$(mktemp -d)
+trap 'rm -rf "$WORK_DIRECTORY"' EXIT
+
+"$@" -O2 -S -o "$WORK_DIRECTORY/memory_codegen.s" memory_codegen.cpp
+
+# The instructions of one function, without directives and labels
+function_body() {
+    awk -v name="$1" '
+        $0 == name ":" { inside = 1; next }
+        inside && /^[ \t]*\.cfi_endproc/ { exit }
+        inside && !/^[ \t]*\./ && !/:$/ { sub(/^[ \t]+/, ""); print }
+    ' "$WORK_DIRECTORY/memory_codegen.s"
+}
+
+check() {
+    name=$1
+    expected=$2
+    body=$(function_body "$name")
+    moves=$(printf '%s\n' "$body" | grep -cE "$expected" || true)
+    shuffles=$(printf '%s\n' "$body" | grep -cE '^(sal|shl|shr|sar|or|rol|ror|xchg|movb|movzbl)' || true)
+
+    if [ "$moves" -ne 1 ] || [ "$shuffles" -ne 0 ]; then
+        echo "FAIL ($name):"
+        printf '%s\n' "$body"
+        exit 1
+    fi
+}
+
+check memory_codegen_load '^movzwl[[:space:]]+[^,]*\('
+check memory_codegen_store '^movw[[:space:]]+%[a-z0-9]+, *[^,]*\('
+
+echo "PASS"
@@ -0,0 +1,36 @@
+#!/bin/sh
+#
+# Checks that a program text decoded in parallel reports an invalid operand at its line in
+# the whole file, not in the part it was decoded in. get_nprocs is overridden to report 8
+# cores, so that the text is cut into several parts whatever the machine.
+#
+# Usage: test_parallel_decode.sh <executable>
+#
+
+set -eu
+
+EXECUTABLE=$(realpath "$1")
+WORK_DIRECTORY=$(mktemp -d)
+trap 'rm -rf "$WORK_DIRECTORY"' EXIT
+
+printf 'int get_nprocs(void) { return 8; }\n' > "$WORK_DIRECTORY/nprocs.c"
+${CC:-cc} -shared -fPIC -o "$WORK_DIRECTORY/nprocs.so" "$WORK_DIRECTORY/nprocs.c"
+
+# 400000 lines of about 9 bytes, enough for several parts of 1 MiB
+awk 'BEGIN { for (line = 1; line <= 400000; ++line) print (line == 350001 ? "SETv a 70000" : "SETv a 1") }' \
+    > "$WORK_DIRECTORY/program.txt"
+
+for LOADER in parallel mmap stream; do
+    if LD_PRELOAD="$WORK_DIRECTORY/nprocs.so" "$EXECUTABLE" --loader "$LOADER" \
+        "$WORK_DIRECTORY/program.txt" > /dev/null 2> "$WORK_DIRECTORY/errors.txt"; then
+        echo "FAIL ($LOADER): the invalid program ran"
+        exit 1
+    fi
+
+    if ! grep -qx 'Error: invalid number 70000 at line 350001' "$WORK_DIRECTORY/errors.txt"; then
+        echo "FAIL ($LOADER): $(cat "$WORK_DIRECTORY/errors.txt")"
+        exit 1
+    fi
+done
+
+echo "PASS"
@@ -0,0 +1,67 @@
+#!/bin/sh
+#
+# Checks that every --prefix continuation starts from the registers, memory and stack the
+# prefix left behind, whatever the continuations before it changed, and that a failing
+# continuation reports its error with its path and does not stop the next ones. This runs in
+# the interpreter and in the JIT, with the default stack and with a guarded one.
+#
+# Usage: test_prefix.sh <executable>
+#
+
+set -eu
+
+EXECUTABLE=$(realpath "$1")
+WORK_DIRECTORY=$(mktemp -d)
+trap 'rm -rf "$WORK_DIRECTORY"' EXIT
+
+# The prefix leaves a = 7, b = 9, 7 at address 10 and 9, 7 on the stack
+printf 'SETv a 7\nSETv b 9\nSTORE 10 a\nPUSH b\nPUSH a\n' > "$WORK_DIRECTORY/prefix.txt"
+
+# Reads the state, then changes a register, the memory and the stack
+cat > "$WORK_DIRECTORY/change.txt" << 'EOF'
+PRINT a
+PRINT b
+LOAD 10 c
+PRINT c
+SETv d 1
+STORE 10 d
+POP c
+PRINT c
+EOF
+
+# Reads the state, then underflows the stack on line 7
+cat > "$WORK_DIRECTORY/underflow.txt" << 'EOF'
+PRINT d
+LOAD 10 c
+PRINT c
+POP a
+POP a
+PRINT a
+POP a
+PRINT a
+EOF
+
+printf '7\n9\n7\n7\n0\n7\n9\n7\n9\n7\n7\n' > "$WORK_DIRECTORY/expected.out"
+echo "$WORK_DIRECTORY/underflow.txt: Error: stack underflow at line 7" \
+    > "$WORK_DIRECTORY/expected.err"
+
+for MODE in "" --jit; do
+    for STACK_SIZE in 16 4096; do
+        if "$EXECUTABLE" $MODE --stack-size "$STACK_SIZE" --prefix "$WORK_DIRECTORY/prefix.txt" \
+            "$WORK_DIRECTORY/change.txt" "$WORK_DIRECTORY/underflow.txt" \
+            "$WORK_DIRECTORY/change.txt" > "$WORK_DIRECTORY/values.out" \
+            2> "$WORK_DIRECTORY/errors.txt"; then
+            echo "FAIL ($MODE stack size $STACK_SIZE): the failing continuation was not reported"
+            exit 1
+        fi
+
+        if ! cmp -s "$WORK_DIRECTORY/values.out" "$WORK_DIRECTORY/expected.out" ||
+            ! cmp -s "$WORK_DIRECTORY/errors.txt" "$WORK_DIRECTORY/expected.err"; then
+            echo "FAIL ($MODE stack size $STACK_SIZE): printed" $(cat "$WORK_DIRECTORY/values.out")
+            cat "$WORK_DIRECTORY/errors.txt"
+            exit 1
+        fi
+    done
+done
+
+echo "PASS"
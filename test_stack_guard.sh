@@ -0,0 +1,48 @@
+#!/bin/sh
+#
+# Checks that on a stack between guard pages, overflowing and underflowing the stack are
+# reported with the line of the faulting PUSH or POP, in the interpreter and in the JIT. A
+# stack of 4096 bytes holds 2048 values, so the 2049th PUSH overflows it.
+#
+# Usage: test_stack_guard.sh <executable>
+#
+
+set -eu
+
+EXECUTABLE=$(realpath "$1")
+WORK_DIRECTORY=$(mktemp -d)
+trap 'rm -rf "$WORK_DIRECTORY"' EXIT
+
+# 2048 pushes behind an empty line fill the stack, and the PUSH on line 2052 overflows it
+awk 'BEGIN { print "SETv a 1"; print ""; for (push = 1; push <= 2048; ++push) print "PUSH a"
+             print "PRINT a"; print "PUSH a" }' > "$WORK_DIRECTORY/overflow.txt"
+printf 'SETv a 3\nPUSH a\n\nPOP b\nPRINT b\nPOP c\nPRINT c\n' > "$WORK_DIRECTORY/underflow.txt"
+
+# The name of each program, the value it prints before the fault and the error of the fault
+for TEST in 'overflow:1:Error: stack overflow at line 2052' \
+    'underflow:3:Error: stack underflow at line 6'; do
+    NAME=${TEST%%:*}
+    VALUE=${TEST#*:}
+    VALUE=${VALUE%%:*}
+    ERROR=${TEST#*:*:}
+
+    for MODE in "" --jit; do
+        if "$EXECUTABLE" $MODE --stack-size 4096 "$WORK_DIRECTORY/$NAME.txt" \
+            > "$WORK_DIRECTORY/values.out" 2> "$WORK_DIRECTORY/errors.txt"; then
+            echo "FAIL ($NAME $MODE): the program ran to its end"
+            exit 1
+        fi
+
+        if [ "$(cat "$WORK_DIRECTORY/errors.txt")" != "$ERROR" ]; then
+            echo "FAIL ($NAME $MODE): $(cat "$WORK_DIRECTORY/errors.txt")"
+            exit 1
+        fi
+
+        if [ "$(cat "$WORK_DIRECTORY/values.out")" != "$VALUE" ]; then
+            echo "FAIL ($NAME $MODE): printed $(cat "$WORK_DIRECTORY/values.out")"
+            exit 1
+        fi
+    done
+done
+
+echo "PASS"
@@ -4,7 +4,7 @@
  *
  * This file provides the implementation for the accessor methods defined in values.hpp.
  * These methods allow access to private constants in the ExitStatusCodes,
- * ErrorMessages, and HardcodedValues classes.
+ * ErrorMessages, CommandLineFlags, and HardcodedValues classes.
  *
  * @date: May 4, 2025
  */
@@ -54,22 +54,6 @@ string_view ErrorMessages::get_unknown_opcode_error() {
     return UNKNOWN_OPCODE_ERROR;
 }
 
-/**
- * Returns writing to stack region error message
- * @return string_view: Writing to stack region error message
- */
-string_view ErrorMessages::get_writing_to_stack_region_error() {
-    return WRITING_TO_STACK_REGION_ERROR;
-}
-
-/**
- * Returns reading from stack region error message
- * @return string_view: Reading from stack region error message
- */
-string_view ErrorMessages::get_reading_from_stack_region_error() {
-    return READING_FROM_STACK_REGION_ERROR;
-}
-
 /**
  * Returns stack overflow error message
  * @return string_view: Stack overflow error message
@@ -94,14 +78,6 @@ string_view ErrorMessages::get_nullptr_operand_error() {
     return NULLPTR_OPERAND_ERROR;
 }
 
-/**
- * Returns invalid register ID error message
- * @return string_view: Invalid register ID error message
- */
-string_view ErrorMessages::get_invalid_register_id_error() {
-    return INVALID_REGISTER_ID_ERROR;
-}
-
 /**
  * Returns invalid opcode type error message
  * @return string_view: Invalid opcode type error message
@@ -118,6 +94,374 @@ string_view ErrorMessages::get_invalid_second_operand_type_error() {
     return INVALID_SECOND_OPERAND_TYPE_ERROR;
 }
 
+/**
+ * Returns address out of memory range error message
+ * @return string_view: Address out of memory range error message
+ */
+string_view ErrorMessages::get_address_out_of_range_error() {
+    return ADDRESS_OUT_OF_RANGE_ERROR;
+}
+
+/**
+ * Returns at line message suffix
+ * @return string_view: At line message suffix
+ */
+string_view ErrorMessages::get_at_line_message() {
+    return AT_LINE_MESSAGE;
+}
+
+/**
+ * Returns JIT allocation error message
+ * @return string_view: JIT allocation error message
+ */
+string_view ErrorMessages::get_jit_allocation_error() {
+    return JIT_ALLOCATION_ERROR;
+}
+
+/**
+ * Returns instance images size error message
+ * @return string_view: Instance images size error message
+ */
+string_view ErrorMessages::get_instance_images_size_error() {
+    return INSTANCE_IMAGES_SIZE_ERROR;
+}
+
+/**
+ * Returns unknown flush policy error
+ * @return string_view: Unknown flush policy error
+ */
+string_view ErrorMessages::get_unknown_flush_policy_error() {
+    return UNKNOWN_FLUSH_POLICY_ERROR;
+}
+
+/**
+ * Returns unknown output format error
+ * @return string_view: Unknown output format error
+ */
+string_view ErrorMessages::get_unknown_output_format_error() {
+    return UNKNOWN_OUTPUT_FORMAT_ERROR;
+}
+
+/**
+ * Returns the error message for an unknown program loader
+ * @return string_view: The error message for an unknown program loader
+ */
+string_view ErrorMessages::get_unknown_loader_error() {
+    return UNKNOWN_LOADER_ERROR;
+}
+
+/**
+ * Returns the error message for a flag that does not exist
+ * @return string_view: The error message for a flag that does not exist
+ */
+string_view ErrorMessages::get_unknown_flag_error() {
+    return UNKNOWN_FLAG_ERROR;
+}
+
+/**
+ * Returns the error message for a flag given without its value
+ * @return string_view: The error message for a flag given without its value
+ */
+string_view ErrorMessages::get_missing_flag_value_error() {
+    return MISSING_FLAG_VALUE_ERROR;
+}
+
+/**
+ * Returns the error message for an argument the chosen mode does not take
+ * @return string_view: The error message for an argument the chosen mode does not take
+ */
+string_view ErrorMessages::get_unexpected_argument_error() {
+    return UNEXPECTED_ARGUMENT_ERROR;
+}
+
+/**
+ * Returns the error message for --prefix given with a mode it does not apply to
+ * @return string_view: The error message for --prefix given with a mode it does not apply to
+ */
+string_view ErrorMessages::get_prefix_mode_error() {
+    return PREFIX_MODE_ERROR;
+}
+
+/**
+ * Returns the error message for a malformed bytecode file
+ * @return string_view: The error message for a malformed bytecode file
+ */
+string_view ErrorMessages::get_malformed_bytecode_error() {
+    return MALFORMED_BYTECODE_ERROR;
+}
+
+/**
+ * Returns the error message for a bytecode file of another format version
+ * @return string_view: The error message for a bytecode file of another format version
+ */
+string_view ErrorMessages::get_bytecode_version_error() {
+    return BYTECODE_VERSION_ERROR;
+}
+
+/**
+ * Returns the error message for a bytecode file whose checksum does not match
+ * @return string_view: The error message for a bytecode file whose checksum does not match
+ */
+string_view ErrorMessages::get_bytecode_checksum_error() {
+    return BYTECODE_CHECKSUM_ERROR;
+}
+
+/**
+ * Returns the error message for an operand that is neither a register nor a uint16 literal
+ * @return string_view: The error message for an operand that is neither a register nor a uint16 literal
+ */
+string_view ErrorMessages::get_invalid_number_error() {
+    return INVALID_NUMBER_ERROR;
+}
+
+/**
+ * Returns the error message for a memory size a machine cannot have
+ * @return string_view: The error message for a memory size a machine cannot have
+ */
+string_view ErrorMessages::get_invalid_memory_size_error() {
+    return INVALID_MEMORY_SIZE_ERROR;
+}
+
+/**
+ * Returns the error message for a stack size a machine cannot have
+ * @return string_view: The error message for a stack size a machine cannot have
+ */
+string_view ErrorMessages::get_invalid_stack_size_error() {
+    return INVALID_STACK_SIZE_ERROR;
+}
+
+/**
+ * Returns the error message for a machine snapshot that cannot be written or restored
+ * @return string_view: The error message for a machine snapshot that cannot be written or restored
+ */
+string_view ErrorMessages::get_snapshot_error() {
+    return SNAPSHOT_ERROR;
+}
+
+/**
+ * Returns the label of the workers report, before the worker index
+ * @return string_view: The label of the workers report, before the worker index
+ */
+string_view ErrorMessages::get_worker_report_message() {
+    return WORKER_REPORT_MESSAGE;
+}
+
+/**
+ * Returns the label of the separator between what a report line is about and its figures
+ * @return string_view: The label of the separator between what a report line is about and its figures
+ */
+string_view ErrorMessages::get_report_separator_message() {
+    return REPORT_SEPARATOR_MESSAGE;
+}
+
+/**
+ * Returns the label of the workers report, after the number of tasks run
+ * @return string_view: The label of the workers report, after the number of tasks run
+ */
+string_view ErrorMessages::get_worker_report_tasks_message() {
+    return WORKER_REPORT_TASKS_MESSAGE;
+}
+
+/**
+ * Returns the label of the workers report, after the number of tasks stolen
+ * @return string_view: The label of the workers report, after the number of tasks stolen
+ */
+string_view ErrorMessages::get_worker_report_stolen_message() {
+    return WORKER_REPORT_STOLEN_MESSAGE;
+}
+
+/**
+ * Returns the label of the workers report, between the busy and the elapsed time
+ * @return string_view: The label of the workers report, between the busy and the elapsed time
+ */
+string_view ErrorMessages::get_worker_report_elapsed_message() {
+    return WORKER_REPORT_ELAPSED_MESSAGE;
+}
+
+/**
+ * Returns the label of reports, after a duration and before its rates
+ * @return string_view: The label of reports, after a duration and before its rates
+ */
+string_view ErrorMessages::get_report_seconds_message() {
+    return REPORT_SECONDS_MESSAGE;
+}
+
+/**
+ * Returns the label of the workers report, after the utilization
+ * @return string_view: The label of the workers report, after the utilization
+ */
+string_view ErrorMessages::get_worker_report_utilization_message() {
+    return WORKER_REPORT_UTILIZATION_MESSAGE;
+}
+
+/**
+ * Returns the label of the load report, before the program path
+ * @return string_view: The label of the load report, before the program path
+ */
+string_view ErrorMessages::get_load_report_message() {
+    return LOAD_REPORT_MESSAGE;
+}
+
+/**
+ * Returns the label of the load report, after the file size
+ * @return string_view: The label of the load report, after the file size
+ */
+string_view ErrorMessages::get_load_report_bytes_message() {
+    return LOAD_REPORT_BYTES_MESSAGE;
+}
+
+/**
+ * Returns the label of the load report, after the number of lines
+ * @return string_view: The label of the load report, after the number of lines
+ */
+string_view ErrorMessages::get_load_report_lines_message() {
+    return LOAD_REPORT_LINES_MESSAGE;
+}
+
+/**
+ * Returns the label of the load report, after the throughput in bytes
+ * @return string_view: The label of the load report, after the throughput in bytes
+ */
+string_view ErrorMessages::get_load_report_megabytes_rate_message() {
+    return LOAD_REPORT_MEGABYTES_RATE_MESSAGE;
+}
+
+/**
+ * Returns the label of the load report, after the throughput in lines
+ * @return string_view: The label of the load report, after the throughput in lines
+ */
+string_view ErrorMessages::get_load_report_lines_rate_message() {
+    return LOAD_REPORT_LINES_RATE_MESSAGE;
+}
+
+/**
+ * Returns JIT flag
+ * @return string_view: JIT flag
+ */
+string_view CommandLineFlags::get_jit_flag() {
+    return JIT_FLAG;
+}
+
+/**
+ * Returns instances flag
+ * @return string_view: Instances flag
+ */
+string_view CommandLineFlags::get_instances_flag() {
+    return INSTANCES_FLAG;
+}
+
+/**
+ * Returns batch flag
+ * @return string_view: Batch flag
+ */
+string_view CommandLineFlags::get_batch_flag() {
+    return BATCH_FLAG;
+}
+
+/**
+ * Returns workers report flag
+ * @return string_view: Workers report flag
+ */
+string_view CommandLineFlags::get_workers_report_flag() {
+    return WORKERS_REPORT_FLAG;
+}
+
+/**
+ * Returns flush flag
+ * @return string_view: Flush flag
+ */
+string_view CommandLineFlags::get_flush_flag() {
+    return FLUSH_FLAG;
+}
+
+/**
+ * Returns output format flag
+ * @return string_view: Output format flag
+ */
+string_view CommandLineFlags::get_output_format_flag() {
+    return OUTPUT_FORMAT_FLAG;
+}
+
+/**
+ * Returns output flag
+ * @return string_view: Output flag
+ */
+string_view CommandLineFlags::get_output_flag() {
+    return OUTPUT_FLAG;
+}
+
+/**
+ * Returns the flag that picks how program files are read
+ * @return string_view: The flag that picks how program files are read
+ */
+string_view CommandLineFlags::get_loader_flag() {
+    return LOADER_FLAG;
+}
+
+/**
+ * Returns the flag that reports the load throughput of the program file
+ * @return string_view: The flag that reports the load throughput of the program file
+ */
+string_view CommandLineFlags::get_load_report_flag() {
+    return LOAD_REPORT_FLAG;
+}
+
+/**
+ * Returns the flag that assembles a program file into a bytecode file
+ * @return string_view: The flag that assembles a program file into a bytecode file
+ */
+string_view CommandLineFlags::get_assemble_flag() {
+    return ASSEMBLE_FLAG;
+}
+
+/**
+ * Returns the flag that writes a program back as text
+ * @return string_view: The flag that writes a program back as text
+ */
+string_view CommandLineFlags::get_disassemble_flag() {
+    return DISASSEMBLE_FLAG;
+}
+
+/**
+ * Returns the flag that sets the decoded-program cache directory
+ * @return string_view: The flag that sets the decoded-program cache directory
+ */
+string_view CommandLineFlags::get_cache_flag() {
+    return CACHE_FLAG;
+}
+
+/**
+ * Returns what every flag starts with, and no program path may
+ * @return string_view: The prefix of every flag
+ */
+string_view CommandLineFlags::get_flag_prefix() {
+    return FLAG_PREFIX;
+}
+
+/**
+ * Returns the flag that sets the memory size of every machine
+ * @return string_view: The flag that sets the memory size of every machine
+ */
+string_view CommandLineFlags::get_memory_size_flag() {
+    return MEMORY_SIZE_FLAG;
+}
+
+/**
+ * Returns the flag that sets the stack size of every machine
+ * @return string_view: The flag that sets the stack size of every machine
+ */
+string_view CommandLineFlags::get_stack_size_flag() {
+    return STACK_SIZE_FLAG;
+}
+
+/**
+ * Returns the flag that runs a program once before several others, each from its end state
+ * @return string_view: The flag that runs a program once before several others
+ */
+string_view CommandLineFlags::get_prefix_flag() {
+    return PREFIX_FLAG;
+}
+
 /**
  * Returns delimiter
  * @return char: Delimiter
@@ -158,22 +502,6 @@ int HardcodedValues::get_second_operand_index() {
     return SECOND_OPERAND_INDEX;
 }
 
-/**
- * Returns minimal program arguments number
- * @return int: Minimal program arguments number
- */
-int HardcodedValues::get_minimal_program_arguments_number() {
-    return MINIMAL_PROGRAM_ARGUMENTS_NUMBER;
-}
-
-/**
- * Returns several operands vector size
- * @return int: Several operands vector size
- */
-int HardcodedValues::get_several_operands_vector_size() {
-    return SEVERAL_OPERANDS_VECTOR_SIZE;
-}
-
 /**
  * Returns stack pointer size
  * @return int: Stack pointer size
@@ -183,18 +511,10 @@ int HardcodedValues::get_stack_pointer_size() {
 }
 
 /**
- * Returns bits in byte
- * @return int: Bits in byte
- */
-int HardcodedValues::get_bits_in_byte() {
-    return BITS_IN_BYTE;
-}
-
-/**
- * Returns stack size
- * @return int: Stack size
+ * Returns the stack size machines have unless another one is chosen at startup
+ * @return size_t: Default stack size, in bytes
  */
-int HardcodedValues::get_stack_size() {
+size_t HardcodedValues::get_stack_size() {
     return STACK_SIZE;
 }
 
@@ -215,9 +535,49 @@ int HardcodedValues::get_second_item_index() {
 }
 
 /**
- * Returns memory size
- * @return size_t: Memory size
+ * Returns the memory size machines have unless another one is chosen at startup
+ * @return size_t: Default memory size, in bytes
  */
 size_t HardcodedValues::get_memory_size() {
     return MEMORY_SIZE;
 }
+
+/**
+ * Returns instances chunk size
+ * @return size_t: Instances chunk size
+ */
+size_t HardcodedValues::get_instances_chunk_size() {
+    return INSTANCES_CHUNK_SIZE;
+}
+
+/**
+ * Returns output buffer size
+ * @return size_t: Output buffer size
+ */
+size_t HardcodedValues::get_output_buffer_size() {
+    return OUTPUT_BUFFER_SIZE;
+}
+
+/**
+ * Returns the smallest part of a program text worth decoding on a thread of its own
+ * @return size_t: The minimum size of a decoding chunk, in bytes
+ */
+size_t HardcodedValues::get_decode_chunk_min_size() {
+    return DECODE_CHUNK_MIN_SIZE;
+}
+
+/**
+ * Returns the largest memory a machine may have, which 16-bit addresses cover
+ * @return size_t: Maximum memory size, in bytes
+ */
+size_t HardcodedValues::get_max_memory_size() {
+    return MAX_MEMORY_SIZE;
+}
+
+/**
+ * Returns the largest stack a machine may have
+ * @return size_t: Maximum stack size, in bytes
+ */
+size_t HardcodedValues::get_max_stack_size() {
+    return MAX_STACK_SIZE;
+}
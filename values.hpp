@@ -7,7 +7,8 @@
  *
  *  - ExitStatusCodes: Contains constants for program exit statuses (success and failure).
  *  - ErrorMessages: Provides formatted error message templates for file I/O issues, unknown
- * opcodes, and memory/stack access violations.
+ * opcodes, and memory/stack access violations, and the labels of the load and workers reports.
+ *  - CommandLineFlags: Defines the optional flags the simulator accepts before the program path.
  *  - HardcodedValues: Defines various configuration constants including command-line argument
  * indices, register values, memory size, stack size, and other limits essential for the simulation.
  *
@@ -46,29 +47,123 @@ class ErrorMessages {
     static string_view get_file_not_provided_error();
     static string_view get_unable_to_open_file_error();
     static string_view get_unknown_opcode_error();
-    static string_view get_writing_to_stack_region_error();
-    static string_view get_reading_from_stack_region_error();
     static string_view get_stack_overflow_error();
     static string_view get_stack_underflow_error();
     static string_view get_nullptr_operand_error();
-    static string_view get_invalid_register_id_error();
     static string_view get_invalid_first_operand_type_error();
     static string_view get_invalid_second_operand_type_error();
+    static string_view get_address_out_of_range_error();
+    static string_view get_at_line_message();
+    static string_view get_jit_allocation_error();
+    static string_view get_instance_images_size_error();
+    static string_view get_unknown_flush_policy_error();
+    static string_view get_unknown_output_format_error();
+    static string_view get_unknown_loader_error();
+    static string_view get_unknown_flag_error();
+    static string_view get_missing_flag_value_error();
+    static string_view get_unexpected_argument_error();
+    static string_view get_prefix_mode_error();
+    static string_view get_malformed_bytecode_error();
+    static string_view get_bytecode_version_error();
+    static string_view get_bytecode_checksum_error();
+    static string_view get_invalid_number_error();
+    static string_view get_invalid_memory_size_error();
+    static string_view get_invalid_stack_size_error();
+    static string_view get_snapshot_error();
+    static string_view get_worker_report_message();
+    static string_view get_report_separator_message();
+    static string_view get_worker_report_tasks_message();
+    static string_view get_worker_report_stolen_message();
+    static string_view get_worker_report_elapsed_message();
+    static string_view get_report_seconds_message();
+    static string_view get_worker_report_utilization_message();
+    static string_view get_load_report_message();
+    static string_view get_load_report_bytes_message();
+    static string_view get_load_report_lines_message();
+    static string_view get_load_report_megabytes_rate_message();
+    static string_view get_load_report_lines_rate_message();
 
    private:
     static constexpr string_view FILE_NOT_PROVIDED_ERROR = "Program file path was not provided.";
     static constexpr string_view UNABLE_TO_OPEN_FILE_ERROR = "Unable to open file: ";
     static constexpr string_view UNKNOWN_OPCODE_ERROR = "Unknown opcode: ";
-    static constexpr string_view WRITING_TO_STACK_REGION_ERROR = "Error: writing to stack region ";
-    static constexpr string_view READING_FROM_STACK_REGION_ERROR =
-        "Error: reading from stack region ";
     static constexpr string_view STACK_OVERFLOW_ERROR = "Error: stack overflow";
     static constexpr string_view STACK_UNDERFLOW_ERROR = "Error: stack underflow";
     static constexpr string_view NULLPTR_OPERAND_ERROR = "Error: working with nullptr operand";
-    static constexpr string_view INVALID_REGISTER_ID_ERROR = "Error: invalid register ID";
     static constexpr string_view INVALID_FIRST_OPERAND_TYPE_ERROR = "Error: invalid first operand";
     static constexpr string_view INVALID_SECOND_OPERAND_TYPE_ERROR =
         "Error: invalid second operand";
+    static constexpr string_view ADDRESS_OUT_OF_RANGE_ERROR = "Error: address out of memory range ";
+    static constexpr string_view AT_LINE_MESSAGE = " at line ";
+    static constexpr string_view JIT_ALLOCATION_ERROR = "Error: unable to allocate executable memory for the JIT";
+    static constexpr string_view INSTANCE_IMAGES_SIZE_ERROR = "Error: instance images file size is not a multiple of the memory size: ";
+    static constexpr string_view UNKNOWN_FLUSH_POLICY_ERROR = "Unknown flush policy: ";
+    static constexpr string_view UNKNOWN_OUTPUT_FORMAT_ERROR = "Unknown output format: ";
+    static constexpr string_view UNKNOWN_LOADER_ERROR = "Unknown program loader: ";
+    static constexpr string_view UNKNOWN_FLAG_ERROR = "Unknown flag: ";
+    static constexpr string_view MISSING_FLAG_VALUE_ERROR = "Missing value for flag: ";
+    static constexpr string_view UNEXPECTED_ARGUMENT_ERROR = "Unexpected argument: ";
+    static constexpr string_view PREFIX_MODE_ERROR = "--prefix cannot be combined with ";
+    static constexpr string_view MALFORMED_BYTECODE_ERROR = "Error: malformed bytecode file: ";
+    static constexpr string_view BYTECODE_VERSION_ERROR = "Error: unsupported bytecode version in file: ";
+    static constexpr string_view BYTECODE_CHECKSUM_ERROR = "Error: bytecode checksum mismatch in file: ";
+    static constexpr string_view INVALID_NUMBER_ERROR = "Error: invalid number ";
+    static constexpr string_view INVALID_MEMORY_SIZE_ERROR = "Error: memory size must be between 2 and 65536 bytes: ";
+    static constexpr string_view INVALID_STACK_SIZE_ERROR = "Error: stack size must be an even number of bytes between 2 and 16777216: ";
+    static constexpr string_view SNAPSHOT_ERROR = "Error: unable to snapshot the machine";
+    static constexpr string_view WORKER_REPORT_MESSAGE = "worker ";
+    static constexpr string_view REPORT_SEPARATOR_MESSAGE = ": ";
+    static constexpr string_view WORKER_REPORT_TASKS_MESSAGE = " tasks, ";
+    static constexpr string_view WORKER_REPORT_STOLEN_MESSAGE = " stolen, busy ";
+    static constexpr string_view WORKER_REPORT_ELAPSED_MESSAGE = " s of ";
+    static constexpr string_view REPORT_SECONDS_MESSAGE = " s (";
+    static constexpr string_view WORKER_REPORT_UTILIZATION_MESSAGE = "%)";
+    static constexpr string_view LOAD_REPORT_MESSAGE = "loaded ";
+    static constexpr string_view LOAD_REPORT_BYTES_MESSAGE = " bytes, ";
+    static constexpr string_view LOAD_REPORT_LINES_MESSAGE = " lines in ";
+    static constexpr string_view LOAD_REPORT_MEGABYTES_RATE_MESSAGE = " MB/s, ";
+    static constexpr string_view LOAD_REPORT_LINES_RATE_MESSAGE = " lines/s)";
+};
+
+/**
+ * A class that stores all command-line flags
+ */
+class CommandLineFlags {
+   public:
+    static string_view get_jit_flag();
+    static string_view get_instances_flag();
+    static string_view get_batch_flag();
+    static string_view get_workers_report_flag();
+    static string_view get_flush_flag();
+    static string_view get_output_format_flag();
+    static string_view get_output_flag();
+    static string_view get_loader_flag();
+    static string_view get_load_report_flag();
+    static string_view get_assemble_flag();
+    static string_view get_disassemble_flag();
+    static string_view get_cache_flag();
+    static string_view get_flag_prefix();
+    static string_view get_memory_size_flag();
+    static string_view get_stack_size_flag();
+    static string_view get_prefix_flag();
+
+   private:
+    static constexpr string_view JIT_FLAG = "--jit";
+    static constexpr string_view INSTANCES_FLAG = "--instances";
+    static constexpr string_view BATCH_FLAG = "--batch";
+    static constexpr string_view WORKERS_REPORT_FLAG = "--workers-report";
+    static constexpr string_view FLUSH_FLAG = "--flush";
+    static constexpr string_view OUTPUT_FORMAT_FLAG = "--output-format";
+    static constexpr string_view OUTPUT_FLAG = "--output";
+    static constexpr string_view LOADER_FLAG = "--loader";
+    static constexpr string_view LOAD_REPORT_FLAG = "--load-report";
+    static constexpr string_view ASSEMBLE_FLAG = "--assemble";
+    static constexpr string_view DISASSEMBLE_FLAG = "--disassemble";
+    static constexpr string_view CACHE_FLAG = "--cache";
+    static constexpr string_view FLAG_PREFIX = "--";
+    static constexpr string_view MEMORY_SIZE_FLAG = "--memory-size";
+    static constexpr string_view STACK_SIZE_FLAG = "--stack-size";
+    static constexpr string_view PREFIX_FLAG = "--prefix";
 };
 
 /**
@@ -80,15 +175,17 @@ class HardcodedValues {
     static int get_program_file_path_index();
     static int get_first_operand_index();
     static int get_second_operand_index();
-    static int get_minimal_program_arguments_number();
-    static int get_several_operands_vector_size();
     static int get_stack_pointer_size();
-    static int get_bits_in_byte();
-    static int get_stack_size();
+    static size_t get_stack_size();
     static int get_first_item_index();
     static int get_second_item_index();
     static size_t get_memory_size();
     static char get_delimiter_symbol();
+    static size_t get_instances_chunk_size();
+    static size_t get_output_buffer_size();
+    static size_t get_decode_chunk_min_size();
+    static size_t get_max_memory_size();
+    static size_t get_max_stack_size();
 
    private:
     static constexpr char DELIMITER_SYMBOL = ' ';
@@ -99,11 +196,13 @@ class HardcodedValues {
     static constexpr int FIRST_OPERAND_INDEX = 1;
     static constexpr int SECOND_ITEM_INDEX = 1;
     static constexpr int SECOND_OPERAND_INDEX = 2;
-    static constexpr int MINIMAL_PROGRAM_ARGUMENTS_NUMBER = 2;
-    static constexpr int SEVERAL_OPERANDS_VECTOR_SIZE = 3;
     static constexpr int STACK_POINTER_SIZE = 2;
-    static constexpr int BITS_IN_BYTE = 8;
-    static constexpr int STACK_SIZE = 16;
+    static constexpr size_t STACK_SIZE = 16;
+    static constexpr size_t INSTANCES_CHUNK_SIZE = 1024;
+    static constexpr size_t OUTPUT_BUFFER_SIZE = 1 << 16;
+    static constexpr size_t DECODE_CHUNK_MIN_SIZE = 1 << 20;
+    static constexpr size_t MAX_MEMORY_SIZE = 1 << 16;
+    static constexpr size_t MAX_STACK_SIZE = 1 << 24;
 };
 
 #endif